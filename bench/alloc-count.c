@@ -0,0 +1,60 @@
+/* Allocation counter for bin/pvt-regress
+
+   Built as alloc-count.so and loaded with LD_PRELOAD, it counts the
+   calls to malloc(), calloc() and realloc(), which include the ones
+   done by operator new, and when the program exits it writes in the
+   file named by the environment variable PVT_ALLOC_REPORT:
+
+       allocations <number of calls>
+       max_rss_kb <peak resident set size>
+
+   It forwards the calls to the glibc entry points __libc_malloc() and
+   the like, so it only works with glibc.
+
+   Aleph-w Leandro Rabindranath Leon
+ */
+# include <stdatomic.h>
+# include <stdio.h>
+# include <stdlib.h>
+# include <sys/resource.h>
+
+extern void * __libc_malloc(size_t);
+extern void * __libc_calloc(size_t, size_t);
+extern void * __libc_realloc(void *, size_t);
+
+static atomic_size_t num_allocs;
+
+void * malloc(size_t size)
+{
+  atomic_fetch_add_explicit(&num_allocs, 1, memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void * calloc(size_t n, size_t size)
+{
+  atomic_fetch_add_explicit(&num_allocs, 1, memory_order_relaxed);
+  return __libc_calloc(n, size);
+}
+
+void * realloc(void * ptr, size_t size)
+{
+  atomic_fetch_add_explicit(&num_allocs, 1, memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+
+__attribute__((destructor)) static void report(void)
+{
+  const char * name = getenv("PVT_ALLOC_REPORT");
+  if (name == NULL)
+    return;
+
+  const size_t n = atomic_load(&num_allocs); /* before fopen() allocates */
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  FILE * f = fopen(name, "w");
+  if (f == NULL)
+    return;
+  fprintf(f, "allocations %zu\nmax_rss_kb %ld\n", n, usage.ru_maxrss);
+  fclose(f);
+}
@@ -0,0 +1,908 @@
+/** PVT microbenchmarks
+
+    Registers two benchmarks for every correlation of the registry,
+    evaluated point by point and in a batch on points sampled inside its
+    declared parameter ranges, plus benchmarks for ParList,
+    DefinedCorrelation, FluidModel, PvtGrid lookups on full, packed and
+    lazily read grids, TiledGrid lookups, Ztuner::solve(),
+    CorrelationInverse, the json loaders of PvtData and EmpiricalData on
+    synthetic archives, EmpiricalData::compute() and the calls to
+    operator new done by a cplot row. The results may be saved in json
+    in order to track regressions between commits.
+
+    Compile and then type
+
+        ./pvt-bench --help
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <unistd.h>
+
+# include <atomic>
+# include <cstdlib>
+# include <new>
+# include <random>
+# include <fstream>
+# include <sstream>
+
+# include <tclap/CmdLine.h>
+
+# include <units.H>
+
+auto & units_instancer = UnitsInstancer::init();
+
+# include <correlations/pvt-correlations.H>
+# include <correlations/defined-correlation.H>
+# include <correlations/fluid-models.H>
+# include <correlations/correlation-inverse.H>
+# include <pvt-grid-compute.H>
+# include <pvt-tiled-grid.H>
+# include <metadata/z-calibrate.H>
+# include <metadata/pvt-calibrate.H>
+# include <metadata/empirical-data.H>
+
+# include "microbench.H"
+
+using namespace TCLAP;
+using namespace Bench;
+
+CmdLine cmd = { "pvt-bench", ' ', "0" };
+
+ValueArg<string> filter = { "f", "filter", "regex selecting the benchmarks",
+			    false, ".", "regex", cmd };
+
+ValueArg<double> min_time = { "t", "min-time",
+			      "minimum running time of each benchmark", false,
+			      0.2, "seconds", cmd };
+
+ValueArg<size_t> num_samples = { "n", "samples",
+				 "number of sampled points per correlation",
+				 false, 64, "number of samples", cmd };
+
+ValueArg<unsigned long> seed = { "s", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+ValueArg<size_t> archive_size = { "", "archive-size",
+				  "number of vectors of the synthetic json "
+				  "archives", false, 2000, "number of vectors",
+				  cmd };
+
+ValueArg<string> json_file = { "j", "json", "save results in json file",
+			       false, "", "file name", cmd };
+
+SwitchArg list = { "l", "list", "list the benchmarks and exit", cmd };
+
+// Calls to operator new, counted for the allocation benchmarks
+atomic<size_t> num_allocations(0);
+
+void * operator new(size_t sz)
+{
+  num_allocations.fetch_add(1, memory_order_relaxed);
+  if (void * ptr = malloc(sz == 0 ? 1 : sz))
+    return ptr;
+  throw bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept { free(ptr); }
+
+void operator delete(void * ptr, size_t) noexcept { free(ptr); }
+
+// Return a value uniformly distributed in [min, max]. Written in this
+// way because some ranges are the limits of the unit and their
+// difference overflows
+double sample(mt19937_64 & rng, double min, double max)
+{
+  const double u = uniform_real_distribution<double>(0, 1)(rng);
+  return (1 - u)*min + u*max;
+}
+
+// Sample up to n rows inside the parameter ranges of corr_ptr. Rows for
+// which the correlation throws are discarded
+Array<DynList<double>> sample_rows(const Correlation * corr_ptr, size_t n,
+				   mt19937_64 & rng)
+{
+  Array<DynList<double>> ret;
+  for (size_t tries = 0; ret.size() < n and tries < 16*n; ++tries)
+    {
+      DynList<double> row;
+      for (auto it = corr_ptr->get_preconditions().get_it(); it.has_curr();
+	   it.next())
+	{
+	  const CorrelationPar & par = it.get_curr();
+	  row.append(sample(rng, par.min_val.raw(), par.max_val.raw()));
+	}
+      try
+	{
+	  corr_ptr->compute(row, false);
+	  ret.append(move(row));
+	}
+      catch (exception &) { /* outside the real domain */ }
+    }
+  return ret;
+}
+
+void register_correlations()
+{
+  mt19937_64 rng(seed.getValue());
+  for (auto it = Correlation::array().get_it(); it.has_curr(); it.next())
+    {
+      const Correlation * corr_ptr = it.get_curr();
+      auto rows = make_shared<Array<DynList<double>>>
+	(sample_rows(corr_ptr, num_samples.getValue(), rng));
+      register_benchmark("corr/" + corr_ptr->name, [corr_ptr, rows]
+			 (State & state)
+        {
+	  if (rows->empty())
+	    {
+	      state.skip_with_error("no valid sample point");
+	      return;
+	    }
+	  const size_t n = rows->size();
+	  size_t i = 0;
+	  while (state.keep_running())
+	    {
+	      try
+		{
+		  do_not_optimize(corr_ptr->compute((*rows)(i), false));
+		}
+	      catch (exception &) {}
+	      if (++i == n)
+		i = 0;
+	    }
+	  state.set_items_processed(state.iterations());
+	});
+
+      // the same points in a batch, through the generated kernel
+      auto args = make_shared<vector<double>>();
+      rows->for_each([&args] (const auto & row)
+        {
+	  row.for_each([&args] (double v) { args->push_back(v); });
+	});
+      register_benchmark("corr/" + corr_ptr->name + "/batch",
+			 [corr_ptr, rows, args] (State & state)
+        {
+	  if (rows->empty())
+	    {
+	      state.skip_with_error("no valid sample point");
+	      return;
+	    }
+	  const size_t n = rows->size();
+	  vector<double> out(n);
+	  while (state.keep_running())
+	    do_not_optimize(corr_ptr->compute_batch(args->data(), n,
+						    out.data(), false,
+						    false));
+	  state.set_items_processed(n*state.iterations());
+	});
+    }
+}
+
+// Parameters of a black oil fluid as cplot inserts them
+ParList fluid_pars()
+{
+  ParList pars;
+  pars.insert("api", 25, &Api::get_instance());
+  pars.insert("yg", 0.8, &Sgg::get_instance());
+  pars.insert("rsb", 600, &SCF_STB::get_instance());
+  pars.insert("tsep", 80, &Fahrenheit::get_instance());
+  pars.insert("psep", 100, &psia::get_instance());
+  pars.insert("n2", 0.01, &MoleFraction::get_instance());
+  pars.insert("co2", 0.01, &MoleFraction::get_instance());
+  pars.insert("h2s", 0, &MoleFraction::get_instance());
+  pars.insert("nacl", 1, &Molality_NaCl::get_instance());
+  pars.insert("t", 150, &Fahrenheit::get_instance());
+  pars.insert("p", 2000, &psia::get_instance());
+  pars.insert("pb", 3000, &psia::get_instance());
+  return pars;
+}
+
+DenseParList dense_fluid_pars()
+{
+  const ParList src = fluid_pars();
+  DenseParList pars;
+  for (auto it = src.tbl.get_it(); it.has_curr(); it.next())
+    {
+      const ParPair & p = it.get_curr();
+      pars.insert(p.first, p.second.first, p.second.second);
+    }
+  return pars;
+}
+
+void register_par_list()
+{
+  register_benchmark("ParList/insert_remove", [] (State & state)
+    {
+      ParList pars = fluid_pars();
+      double p = 100;
+      while (state.keep_running())
+	{
+	  pars.insert("p", p, &psia::get_instance());
+	  pars.remove("p");
+	  p += 1;
+	}
+      state.set_items_processed(state.iterations());
+    });
+
+  register_benchmark("ParList/search", [] (State & state)
+    {
+      const ParList pars = fluid_pars();
+      const string names[] = { "api", "yg", "t", "p", "pb", "nacl" };
+      size_t i = 0;
+      while (state.keep_running())
+	{
+	  do_not_optimize(pars.search(names[i]).raw());
+	  if (++i == 6)
+	    i = 0;
+	}
+      state.set_items_processed(state.iterations());
+    });
+
+  register_benchmark("DenseParList/insert_remove", [] (State & state)
+    {
+      DenseParList pars = dense_fluid_pars();
+      const size_t p_id = par_id("p");
+      double p = 100;
+      while (state.keep_running())
+	{
+	  pars.insert(p_id, p, &psia::get_instance());
+	  pars.remove(p_id);
+	  p += 1;
+	}
+      state.set_items_processed(state.iterations());
+    });
+
+  register_benchmark("DenseParList/search", [] (State & state)
+    {
+      const DenseParList pars = dense_fluid_pars();
+      const size_t ids[] = { par_id("api"), par_id("yg"), par_id("t"),
+			     par_id("p"), par_id("pb"), par_id("nacl") };
+      size_t i = 0;
+      while (state.keep_running())
+	{
+	  do_not_optimize(pars.search(ids[i]).raw());
+	  if (++i == 6)
+	    i = 0;
+	}
+      state.set_items_processed(state.iterations());
+    });
+}
+
+// A row as cplot computes it: rs at p, then bob and cob with that rs,
+// all of them by names. The counter allocs_per_row is the number of
+// calls to operator new per row
+void register_row_allocations()
+{
+  const Correlation * rs_ptr = Correlation::search_by_name("RsStanding");
+  const Correlation * bob_ptr = Correlation::search_by_name("BobStanding");
+  const Correlation * cob_ptr = Correlation::search_by_name("CobMcCainEtAl");
+
+  register_benchmark("alloc/row/ParList", [=] (State & state)
+    {
+      ParList pars = fluid_pars();
+      pars.remove("p");
+      const size_t before = num_allocations;
+      double p = 500;
+      while (state.keep_running())
+	{
+	  pars.insert("p", p, &psia::get_instance());
+	  const VtlQuantity rs = rs_ptr->compute_by_names(pars, false);
+	  pars.insert("rs", rs);
+	  do_not_optimize(bob_ptr->compute_by_names(pars, false).raw());
+	  do_not_optimize(cob_ptr->compute_by_names(pars, false).raw());
+	  pars.remove("rs");
+	  pars.remove("p");
+	  p = p < 5000 ? p + 1 : 500;
+	}
+      state.set_items_processed(state.iterations());
+      state.set_counter("allocs_per_row",
+			double(num_allocations - before)/state.iterations());
+    });
+
+  register_benchmark("alloc/row/DenseParList", [=] (State & state)
+    {
+      DenseParList pars = dense_fluid_pars();
+      const size_t p_id = par_id("p"), rs_id = par_id("rs");
+      pars.remove(p_id);
+      const size_t before = num_allocations;
+      double p = 500;
+      while (state.keep_running())
+	{
+	  pars.insert(p_id, p, &psia::get_instance());
+	  const VtlQuantity rs = rs_ptr->compute_by_names(pars, false);
+	  pars.insert(rs_id, rs);
+	  do_not_optimize(bob_ptr->compute_by_names(pars, false).raw());
+	  do_not_optimize(cob_ptr->compute_by_names(pars, false).raw());
+	  pars.remove(rs_id);
+	  pars.remove(p_id);
+	  p = p < 5000 ? p + 1 : 500;
+	}
+      state.set_items_processed(state.iterations());
+      state.set_counter("allocs_per_row",
+			double(num_allocations - before)/state.iterations());
+    });
+
+  // the same row through lists of named parameters, which are built
+  // on the heap
+  register_benchmark("alloc/row/NamedPar", [=] (State & state)
+    {
+      const Unit * sgg = &Sgg::get_instance(), * api = &Api::get_instance();
+      const Unit * f = &Fahrenheit::get_instance();
+      const size_t before = num_allocations;
+      double p = 500;
+      while (state.keep_running())
+	{
+	  DynList<Correlation::NamedPar> pars =
+	    { Correlation::NamedPar(true, "yg", 0.8, sgg),
+	      Correlation::NamedPar(true, "api", 25, api),
+	      Correlation::NamedPar(true, "rsb", 600, &SCF_STB::get_instance()),
+	      Correlation::NamedPar(true, "t", 150, f),
+	      Correlation::NamedPar(true, "p", p, &psia::get_instance()) };
+	  const VtlQuantity rs = rs_ptr->compute_by_names(pars, false);
+	  pars.append(Correlation::NamedPar(true, "rs", rs.raw(), &rs.unit));
+	  do_not_optimize(bob_ptr->compute_by_names(pars, false).raw());
+	  do_not_optimize(cob_ptr->compute_by_names(pars, false).raw());
+	  p = p < 5000 ? p + 1 : 500;
+	}
+      state.set_items_processed(state.iterations());
+      state.set_counter("allocs_per_row",
+			double(num_allocations - before)/state.iterations());
+    });
+}
+
+void register_defined_correlation()
+{
+  register_benchmark("DefinedCorrelation/bw", [] (State & state)
+    {
+      const Correlation * below = Correlation::search_by_name("BwbMcCain");
+      const Correlation * above = Correlation::search_by_name("BwaMcCain");
+      if (below == nullptr or above == nullptr)
+	{
+	  state.skip_with_error("BwbMcCain or BwaMcCain not found");
+	  return;
+	}
+
+      const double pb = 3000;
+      DefinedCorrelation corr("p", psia::get_instance());
+      corr.add_correlation(below, 1000, pb);
+      corr.add_correlation(above, nextafter(pb, 1e10), 5000);
+
+      ParList pars = fluid_pars();
+      pars.insert("bwbp", 1.02, &RB_STB::get_instance());
+      pars.insert("cwa", 3e-6, &psia_1::get_instance());
+
+      double p = 1000; // sweep both intervals
+      while (state.keep_running())
+	{
+	  pars.remove("p");
+	  pars.insert("p", p, &psia::get_instance());
+	  try
+	    {
+	      do_not_optimize(corr.compute_by_names(pars, false).raw());
+	    }
+	  catch (exception &) {}
+	  p = p < 5000 ? p + 10 : 1000;
+	}
+      state.set_items_processed(state.iterations());
+    });
+}
+
+// A black oil isotherm of 100 pressures with the Standard set. Both
+// benchmarks compute the same properties: pb, uod, bobp and uobp once,
+// and rs, co, bo and uo at every pressure with the correlations below
+// or above pb. The first one uses FluidModel and the second one
+// Correlation::compute_by_names()
+void register_fluid_model()
+{
+  auto isotherm = [] (State & state, bool fluid_model)
+    {
+      FluidModelStandard model(Fahrenheit::get_instance(),
+			       psia::get_instance());
+      const ParList pars = fluid_pars();
+      for (auto & name : { "api", "yg", "rsb", "tsep", "psep" })
+	model.set_constant(name, pars.search(name));
+      model.prepare();
+
+      Array<double> ps;
+      for (size_t i = 0; i < 100; ++i)
+	ps.append(15 + i*(5000.0 - 15)/99);
+
+      ParList dpars = pars;
+      for (auto & name : { "uod", "bobp", "uobp", "rs", "coa", "bob", "uo" })
+	dpars.insert(name, VtlQuantity::null_quantity);
+      auto set = [&dpars] (const string & name, const VtlQuantity & q)
+	{
+	  dpars.remove(name);
+	  dpars.insert(name, q);
+	};
+      auto compute = [&dpars] (const Correlation & corr)
+	{
+	  return corr.compute_by_names(dpars, false);
+	};
+
+      const VtlQuantity rsb = pars.search("rsb");
+      auto by_names = [&] ()
+	{
+	  set("t", VtlQuantity(Fahrenheit::get_instance(), 150));
+	  const VtlQuantity pb = compute(PbStanding::get_instance());
+	  set("pb", pb);
+	  set("uod", compute(UodBeggsRobinson::get_instance()));
+	  set("p", pb);
+	  set("rs", rsb);
+	  set("bobp", compute(BobStanding::get_instance()));
+	  set("uobp", compute(UobBeggsRobinson::get_instance()));
+
+	  size_t n = 0;
+	  for (auto it = ps.get_it(); it.has_curr(); it.next())
+	    try
+	      {
+		const double p = it.get_curr();
+		set("p", VtlQuantity(psia::get_instance(), p));
+		const bool below = p <= pb.raw();
+		const VtlQuantity rs =
+		  below ? compute(RsStanding::get_instance()) :
+		  compute(RsAbovePb::get_instance());
+		set("rs", rs.raw() > rsb.raw() ? rsb : rs);
+		set("coa", below ? compute(CobMcCainEtAl::get_instance()) :
+		    compute(CoaVasquezBeggs::get_instance()));
+		set("bob", below ? compute(BobStanding::get_instance()) :
+		    compute(BoaMcCain::get_instance()));
+		set("uo", below ? compute(UobBeggsRobinson::get_instance()) :
+		    compute(UoaVasquezBeggs::get_instance()));
+		++n;
+	      }
+	    catch (exception &) {}
+	  return n;
+	};
+
+      while (state.keep_running())
+	if (fluid_model)
+	  do_not_optimize(model.isotherm(150, ps).size());
+	else
+	  do_not_optimize(by_names());
+      state.set_items_processed(100*state.iterations());
+    };
+
+  register_benchmark("FluidModel/Standard/isotherm",
+		     [isotherm] (State & state) { isotherm(state, true); });
+  register_benchmark("FluidModel/Standard/by_names",
+		     [isotherm] (State & state) { isotherm(state, false); });
+}
+
+// Synthetic black oil like grid with nt temperatures and np pressures
+string grid_csv(size_t nt, size_t np)
+{
+  ostringstream s;
+  s << "t Fahrenheit,p psia,bo RB_STB,rs SCF_STB,uo CP" << endl;
+  for (size_t i = 0; i < nt; ++i)
+    {
+      const double t = 80 + i*(280.0 - 80)/(nt - 1);
+      for (size_t j = 0; j < np; ++j)
+	{
+	  const double p = 15 + j*(5000.0 - 15)/(np - 1);
+	  s << t << "," << p << "," << 1 + 1e-4*p + 1e-4*t << ","
+	    << 0.2*p + t << "," << 10/(1 + 1e-3*p) + 100/t << endl;
+	}
+    }
+  return s.str();
+}
+
+void register_pvt_grid()
+{
+  istringstream in(grid_csv(20, 100));
+  auto grid = make_shared<PvtGrid>(in);
+
+  auto lookup = [] (shared_ptr<PvtGrid> grid, State & state,
+		    size_t name_idx, bool derivatives)
+    {
+      mt19937_64 rng(seed.getValue());
+      Array<pair<VtlQuantity, VtlQuantity>> points;
+      for (size_t i = 0; i < 1024; ++i)
+	points.append(make_pair
+		      (VtlQuantity(Fahrenheit::get_instance(),
+				   sample(rng, 80, 280)),
+		       VtlQuantity(psia::get_instance(),
+				   sample(rng, 15, 5000))));
+      size_t i = 0;
+      while (state.keep_running())
+	{
+	  const auto & point = points(i);
+	  if (derivatives)
+	    do_not_optimize(grid->compute_with_derivatives
+			    (name_idx, point.first, point.second).dp);
+	  else
+	    do_not_optimize(grid->compute
+			    (name_idx, point.first, point.second).raw());
+	  if (++i == points.size())
+	    i = 0;
+	}
+      state.set_items_processed(state.iterations());
+    };
+
+  register_benchmark("PvtGrid/compute", [lookup, grid] (State & state)
+		     { lookup(grid, state, 0, false); });
+  register_benchmark("PvtGrid/compute_with_derivatives",
+		     [lookup, grid] (State & state)
+		     { lookup(grid, state, 0, true); });
+
+  // the same lookups on packed grids; bytes is the ratio between the
+  // memory of the full grid and the packed one
+  using Encoding = PvtGrid::Encoding;
+  for (auto enc : { Encoding::Float, Encoding::Fixed16, Encoding::Delta8 })
+    {
+      istringstream in(grid_csv(20, 100));
+      auto packed = make_shared<PvtGrid>(in);
+      packed->compress(1e-4, enc);
+      const double ratio = double(grid->memory_bytes())/packed->memory_bytes();
+      register_benchmark(string("PvtGrid/compute/") +
+			 PackedColumn::encoding_name(enc),
+			 [lookup, packed, ratio] (State & state)
+			 {
+			   lookup(packed, state, 0, false);
+			   state.set_counter("bytes_ratio", ratio);
+			   state.set_counter("max_error",
+					     packed->max_compression_error());
+			 });
+    }
+  // 1024 points on 16 isotherms, in batches and one by one without
+  // throwing
+  auto batch = [grid] (State & state, bool one_by_one)
+    {
+      mt19937_64 rng(seed.getValue());
+      vector<double> t(1024), p(1024), out(1024);
+      for (size_t i = 0; i < t.size(); ++i)
+	{
+	  t[i] = 80 + (i/64)*(280.0 - 80)/15;
+	  p[i] = sample(rng, 15, 5000);
+	}
+      while (state.keep_running())
+	{
+	  if (one_by_one)
+	    for (size_t i = 0; i < t.size(); ++i)
+	      out[i] = grid->compute(0, t[i], p[i], PvtGrid::Lookup::NaN);
+	  else
+	    grid->compute_batch(0, t.data(), p.data(), t.size(), out.data());
+	  do_not_optimize(out[0]);
+	}
+      state.set_items_processed(t.size()*state.iterations());
+    };
+  register_benchmark("PvtGrid/compute/nan", [batch] (State & state)
+		     { batch(state, true); });
+  register_benchmark("PvtGrid/compute_batch", [batch] (State & state)
+		     { batch(state, false); });
+  register_benchmark("PvtGrid/compute_by_name", [grid] (State & state)
+    {
+      const VtlQuantity t(Fahrenheit::get_instance(), 150);
+      const VtlQuantity p(psia::get_instance(), 2000);
+      while (state.keep_running())
+	do_not_optimize(grid->compute("uo", t, p).raw());
+      state.set_items_processed(state.iterations());
+    });
+}
+
+// Lookups of uo on a TiledGrid of the Standard set. hot repeats 1024
+// points of a small region, whose tiles are computed once; cold clears
+// the cache every 1024 lookups
+void register_tiled_grid()
+{
+  auto model = make_shared<FluidModelStandard>(Fahrenheit::get_instance(),
+					       psia::get_instance());
+  const ParList pars = fluid_pars();
+  for (auto & name : { "api", "yg", "rsb", "tsep", "psep" })
+    model->set_constant(name, pars.search(name));
+  model->prepare();
+
+  using Grid = TiledGrid<FluidModelStandard>;
+  auto grid = make_shared<Grid>(*model, Grid::Axis(80, 280, 101),
+				Grid::Axis(15, 5000, 501));
+  const size_t uo = grid->property_index("uo");
+
+  auto lookup = [model, grid, uo] (State & state, double tmax, double pmax,
+				   bool clear)
+    {
+      mt19937_64 rng(seed.getValue());
+      Array<pair<VtlQuantity, VtlQuantity>> points;
+      for (size_t i = 0; i < 1024; ++i)
+	points.append(make_pair
+		      (VtlQuantity(Fahrenheit::get_instance(),
+				   sample(rng, 80, tmax)),
+		       VtlQuantity(psia::get_instance(),
+				   sample(rng, 15, pmax))));
+      size_t i = 0;
+      while (state.keep_running())
+	{
+	  const auto & point = points(i);
+	  try
+	    {
+	      do_not_optimize(grid->compute(uo, point.first,
+					    point.second).raw());
+	    }
+	  catch (exception &) {}
+	  if (++i == points.size())
+	    {
+	      i = 0;
+	      if (clear)
+		grid->clear();
+	    }
+	}
+      state.set_items_processed(state.iterations());
+      state.set_counter("tiles", grid->resident_tiles());
+    };
+
+  register_benchmark("TiledGrid/compute/hot", [lookup] (State & state)
+		     { lookup(state, 100, 1000, false); });
+  register_benchmark("TiledGrid/compute/cold", [lookup] (State & state)
+		     { lookup(state, 280, 5000, true); });
+}
+
+// Time until the first lookup of a 200 x 200 grid read from a file,
+// fully and through its index
+void register_pvt_grid_open()
+{
+  static char name[] = "/tmp/pvt-bench-grid-XXXXXX";
+  const int fd = mkstemp(name);
+  if (fd < 0)
+    return;
+  close(fd);
+  const string file_name = name;
+  ofstream(file_name) << grid_csv(200, 200);
+  PvtGrid::write_index(file_name);
+  atexit([]
+	 {
+	   unlink(name);
+	   unlink(PvtGrid::index_name(name).c_str());
+	 });
+
+  const VtlQuantity t(Fahrenheit::get_instance(), 150);
+  const VtlQuantity p(psia::get_instance(), 2000);
+  register_benchmark("PvtGrid/open/eager", [file_name, t, p] (State & state)
+    {
+      while (state.keep_running())
+	{
+	  ifstream in(file_name);
+	  PvtGrid grid(in);
+	  do_not_optimize(grid.compute(size_t(0), t, p).raw());
+	}
+      state.set_items_processed(state.iterations());
+    });
+  register_benchmark("PvtGrid/open/lazy", [file_name, t, p] (State & state)
+    {
+      while (state.keep_running())
+	{
+	  PvtGrid grid(file_name, 8);
+	  do_not_optimize(grid.compute(size_t(0), t, p).raw());
+	}
+      state.set_items_processed(state.iterations());
+    });
+}
+
+// z values of the tests/z5.json fluid
+const char * ztuner_json = R"({
+  "yg": 0.608, "n2": 0.0019, "co2": 0.0086, "h2s": 0.0,
+  "zvals": [ { "t": 125.0, "p": [ 15.0, 300.0, 450.0, 600.0 ],
+               "z": [ 0.9981, 0.9686, 0.9539, 0.9417 ] } ]
+})";
+
+void register_ztuner()
+{
+  register_benchmark("Ztuner/solve", [] (State & state)
+    {
+      istringstream in(ztuner_json);
+      Ztuner tuner(in);
+      while (state.keep_running())
+	{
+	  tuner.exception_list.empty();
+	  do_not_optimize(tuner.solve(false).size());
+	}
+    });
+}
+
+// rsb of PbStanding for 1024 bubble point pressures of the same fluid.
+// The items are the inverted targets; the counters are the mean
+// evaluations per target
+void register_correlation_inverse()
+{
+  const Correlation * corr_ptr = Correlation::search_by_name("PbStanding");
+  auto targets = make_shared<vector<double>>();
+  for (size_t i = 0; i < 1024; ++i)
+    targets->push_back(500 + 2*i);
+
+  auto bench = [corr_ptr, targets] (size_t num_threads)
+    {
+      return [corr_ptr, targets, num_threads] (State & state)
+        {
+	  CorrelationInverse inv(corr_ptr, "rsb");
+	  inv.set_num_threads(num_threads);
+	  const double args[] = { 0.8, 0, 30, 180 }; // yg, rsb, api, t
+	  const size_t n = targets->size();
+	  vector<CorrelationInverse::Result> out(n);
+	  while (state.keep_running())
+	    do_not_optimize(inv.solve_batch(args, 0, targets->data(), n,
+					    out.data()));
+	  size_t evals = 0;
+	  for (auto & r : out)
+	    evals += r.evaluations;
+	  state.set_items_processed(n*state.iterations());
+	  state.set_counter("evaluations", double(evals)/n);
+	};
+    };
+  register_benchmark("CorrelationInverse/solve_batch", bench(1));
+  register_benchmark("CorrelationInverse/solve_batch/4threads", bench(4));
+}
+
+// PvtData json with n rs vectors of 64 pressures, each one at a
+// different temperature
+string pvt_data_json(size_t n)
+{
+  ostringstream s;
+  s << "{\"constants\":[{\"name\":\"api\",\"unit\":\""
+    << Api::get_instance().name << "\",\"value\":25.0}],\"vectors\":[";
+  for (size_t i = 0; i < n; ++i)
+    {
+      const double t = 100 + i*0.05, pb = 2000 + i;
+      s << (i ? "," : "") << "{\"bobp\":1.25,\"pb\":" << pb
+	<< ",\"punit\":\"" << psia::get_instance().name
+	<< "\",\"t\":" << t << ",\"target_name\":\"rs\",\"target_unit\":\""
+	<< SCF_STB::get_instance().name
+	<< "\",\"uobp\":1.1,\"uod\":3.5,\"p\":[";
+      for (size_t j = 0; j < 64; ++j)
+	s << (j ? "," : "") << 15 + j*pb/63;
+      s << "],\"y\":[";
+      for (size_t j = 0; j < 64; ++j)
+	s << (j ? "," : "") << 0.2*(15 + j*pb/63) + 1e-3*t;
+      s << "]}";
+    }
+  s << "]}";
+  return s.str();
+}
+
+// EmpiricalData json with n var sets of 4 variables and 16 samples
+string empirical_data_json(size_t n)
+{
+  ostringstream s;
+  s << "{\"name\":\"synthetic\",\"description\":\"bench\",\"constants\":"
+    << "[{\"name\":\"api\",\"unit\":\"" << Api::get_instance().name
+    << "\",\"value\":25.0}],\"varsets\":[";
+  const char * names[] = { "t", "p", "rs", "bob" };
+  const Unit * units[] = { &Fahrenheit::get_instance(), &psia::get_instance(),
+			   &SCF_STB::get_instance(), &RB_STB::get_instance() };
+  for (size_t i = 0; i < n; ++i)
+    {
+      s << (i ? "," : "") << "{\"description\":\"set\",\"name\":\"set"
+	<< i << "\",\"num samples\":16,\"num vars\":4,\"samples\":{";
+      for (size_t k = 0; k < 4; ++k)
+	{
+	  s << (k ? "," : "") << "\"" << names[k] << "\":[";
+	  for (size_t j = 0; j < 16; ++j)
+	    s << (j ? "," : "") << 100 + i + (k + 1)*j*1.5;
+	  s << "]";
+	}
+      s << "},\"variables\":[";
+      for (size_t k = 0; k < 4; ++k)
+	s << (k ? "," : "") << "{\"name\":\"" << names[k] << "\",\"unit\":\""
+	  << units[k]->symbol << "\"}";
+      s << "]}";
+    }
+  s << "]}";
+  return s.str();
+}
+
+// Load the archives through a json document and through the streaming
+// reader. The items are the loaded vectors
+void register_json_loaders()
+{
+  const size_t n = archive_size.getValue();
+  auto pvt = make_shared<string>(pvt_data_json(n));
+  auto empirical = make_shared<string>(empirical_data_json(n));
+
+  register_benchmark("json/PvtData/document", [pvt, n] (State & state)
+    {
+      while (state.keep_running())
+	{
+	  istringstream in(*pvt);
+	  PvtData data(Json::parse(in));
+	  do_not_optimize(data.vectors.size());
+	}
+      state.set_items_processed(n*state.iterations());
+    });
+  register_benchmark("json/PvtData/stream", [pvt, n] (State & state)
+    {
+      while (state.keep_running())
+	{
+	  istringstream in(*pvt);
+	  PvtData data(in);
+	  do_not_optimize(data.vectors.size());
+	}
+      state.set_items_processed(n*state.iterations());
+    });
+  register_benchmark("json/EmpiricalData/document", [empirical, n]
+		     (State & state)
+    {
+      while (state.keep_running())
+	{
+	  EmpiricalData data;
+	  data.set_from_json(json::parse(*empirical));
+	  do_not_optimize(data.var_sets.size());
+	}
+      state.set_items_processed(n*state.iterations());
+    });
+  register_benchmark("json/EmpiricalData/stream", [empirical, n]
+		     (State & state)
+    {
+      while (state.keep_running())
+	{
+	  istringstream in(*empirical);
+	  EmpiricalData data(in);
+	  do_not_optimize(data.var_sets.size());
+	}
+      state.set_items_processed(n*state.iterations());
+    });
+}
+
+// BobStanding over every var set of an EmpiricalData: point by point
+// from the rows and in a batch over the columns. The items are the
+// computed samples
+void register_empirical_compute()
+{
+  const size_t n = archive_size.getValue();
+  auto data = make_shared<EmpiricalData>(empirical_data_json(n));
+  data->def_const("yg", 0.75, &Sgg::get_instance());
+  const Correlation * corr_ptr = Correlation::search_by_name("BobStanding");
+
+  register_benchmark("EmpiricalData/compute/rows", [data, corr_ptr, n]
+		     (State & state)
+    {
+      while (state.keep_running())
+	for (size_t i = 0; i < n; ++i)
+	  data->correlation_perms(i, corr_ptr).for_each([&] (const auto & l)
+	    {
+	      do_not_optimize(corr_ptr->compute(l, false));
+	    });
+      state.set_items_processed(16*n*state.iterations());
+    });
+  register_benchmark("EmpiricalData/compute/columns", [data, corr_ptr, n]
+		     (State & state)
+    {
+      while (state.keep_running())
+	for (size_t i = 0; i < n; ++i)
+	  do_not_optimize(data->compute(i, corr_ptr, false).get_last());
+      state.set_items_processed(16*n*state.iterations());
+    });
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  register_correlations();
+  register_par_list();
+  register_row_allocations();
+  register_defined_correlation();
+  register_fluid_model();
+  register_pvt_grid();
+  register_pvt_grid_open();
+  register_tiled_grid();
+  register_ztuner();
+  register_correlation_inverse();
+  register_json_loaders();
+  register_empirical_compute();
+
+  if (list.getValue())
+    {
+      for (auto it = benchmarks().get_it(); it.has_curr(); it.next())
+	cout << it.get_curr().name << endl;
+      return 0;
+    }
+
+  const Json j = run_benchmarks(argv[0], filter.getValue(),
+				min_time.getValue(), cout);
+
+  if (json_file.isSet())
+    {
+      ofstream out(json_file.getValue());
+      if (not out)
+	error_msg("cannot open " + json_file.getValue());
+      out << j.dump(2) << endl;
+    }
+
+  return 0;
+}
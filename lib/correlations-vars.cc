@@ -18,6 +18,13 @@ Array<const Correlation *> Correlation::correlations_tbl;
 
 CorrelationInstantiater __correlations; 
 
+// the mode of the library; see pvt-fast-math.H
+# ifdef PVT_FAST_MATH
+const int PvtFastMath::Mode_Fast = 1;
+# else
+const int PvtFastMath::Mode_Exact = 0;
+# endif
+
 static json to_json(const CorrelationPar & p) 
 {
   json j;
@@ -1 +0,0 @@
-../tests/cplot.cc
\ No newline at end of file
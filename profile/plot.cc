@@ -1 +0,0 @@
-../tests/plot.cc
\ No newline at end of file
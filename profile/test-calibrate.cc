@@ -1 +0,0 @@
-../tests/test-calibrate.cc
\ No newline at end of file
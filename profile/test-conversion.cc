@@ -1 +0,0 @@
-../tests/test-conversion.cc
\ No newline at end of file
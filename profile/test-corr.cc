@@ -1 +0,0 @@
-../tests/test-corr.cc
\ No newline at end of file
@@ -0,0 +1,459 @@
+/** PVT correlation evaluation server
+
+    Long running process that loads the correlation registry once and
+    answers catalogue, lookup, batch evaluation and grid requests
+    through a unix domain socket. See protocol.H for the wire format.
+
+    Each connection has a reader thread that decodes frames and queues
+    them; a pool of workers evaluates the requests and writes back the
+    answers. So a client may pipeline requests. The queue is bounded:
+    when it is full, the reader answers Busy instead of queuing.
+
+    On SIGINT or SIGTERM the server stops accepting connections and
+    reading the open ones, joins the readers, lets the workers finish
+    the queued requests, joins them and removes the socket. So no
+    thread uses the queue after main() returns.
+
+    Compile and then type
+
+        ./pvt-server --help
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+
+# include <atomic>
+# include <csignal>
+# include <cmath>
+# include <deque>
+# include <list>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <condition_variable>
+
+# include <sys/socket.h>
+# include <sys/un.h>
+
+# include <tclap/CmdLine.h>
+
+# include <correlations/pvt-correlations.H>
+
+# include "protocol.H"
+
+using namespace std;
+using namespace TCLAP;
+using namespace PvtServer;
+
+CmdLine cmd = { "pvt-server", ' ', "0" };
+
+ValueArg<string> socket_path = { "s", "socket", "unix socket path", false,
+				 Default_Socket_Path, "socket path", cmd };
+
+ValueArg<size_t> num_workers = { "w", "workers", "number of workers", false,
+				 thread::hardware_concurrency(),
+				 "number of workers", cmd };
+
+ValueArg<size_t> queue_size = { "q", "queue", "maximum of pending requests",
+				false, 1024, "maximum of pending requests",
+				cmd };
+
+SwitchArg verbose = { "v", "verbose", "report connections", cmd };
+
+// A client connection. It is shared between its reader thread and the
+// workers serving its requests; the socket is closed when the last of
+// them releases it
+struct Connection
+{
+  const int fd;
+  mutex write_mutex; // answers of different workers must not interleave
+  atomic<bool> reader_done = { false };
+
+  Connection(int fd) : fd(fd) {}
+
+  ~Connection() { close(fd); }
+
+  void answer(uint32_t id, Op op, Status status, const Writer & w)
+  {
+    lock_guard<mutex> lock(write_mutex);
+    write_frame(fd, id, op, status, w);
+  }
+
+  void answer_error(uint32_t id, Op op, const string & msg)
+  {
+    Writer w;
+    w.put(msg);
+    answer(id, op, Status::Failed, w);
+  }
+};
+
+struct Request
+{
+  shared_ptr<Connection> conn;
+  FrameHeader header;
+  vector<char> payload;
+};
+
+// Bounded queue of requests shared by all the readers and workers
+class RequestQueue
+{
+  deque<Request> q;
+  size_t capacity = 1;
+  bool closed = false;
+  mutex m;
+  condition_variable cond;
+
+public:
+
+  void set_capacity(size_t n)
+  {
+    lock_guard<mutex> lock(m);
+    capacity = max<size_t>(n, 1);
+  }
+
+  /// Queue req if the queue is not full nor closed. Return false
+  /// otherwise; in this case req is not moved
+  bool put(Request && req)
+  {
+    {
+      lock_guard<mutex> lock(m);
+      if (closed or q.size() >= capacity)
+	return false;
+      q.push_back(move(req));
+    }
+    cond.notify_one();
+    return true;
+  }
+
+  /// Wait for a request. Return false when the queue has been closed
+  /// and all its requests have been taken
+  bool get(Request & req)
+  {
+    unique_lock<mutex> lock(m);
+    cond.wait(lock, [this] { return closed or not q.empty(); });
+    if (q.empty())
+      return false;
+    req = move(q.front());
+    q.pop_front();
+    return true;
+  }
+
+  /// Refuse new requests and wake up the workers
+  void close()
+  {
+    {
+      lock_guard<mutex> lock(m);
+      closed = true;
+    }
+    cond.notify_all();
+  }
+};
+
+RequestQueue requests;
+
+const Correlation * search_correlation(uint32_t id)
+{
+  const auto & corrs = Correlation::array();
+  if (id >= corrs.size())
+    ZENTHROW(CorrelationNotFound, "correlation id " + to_string(id) +
+	     " not found");
+  return corrs(id);
+}
+
+// Evaluate corr_ptr for a row of values in the declared units. Return
+// false if the correlation throws
+bool evaluate(const Correlation * corr_ptr, const double * row, bool check,
+	      double & result)
+{
+  DynList<double> vals;
+  for (size_t j = 0; j < corr_ptr->get_num_pars(); ++j)
+    vals.append(row[j]);
+  try
+    {
+      result = check ? corr_ptr->compute_and_check(vals, true) :
+	corr_ptr->compute(vals, false);
+      return true;
+    }
+  catch (exception &)
+    {
+      result = NAN;
+      return false;
+    }
+}
+
+void serve_catalogue(const Request & req)
+{
+  Writer w;
+  w.put(Correlation::json_of_all_correlations());
+  req.conn->answer(req.header.id, Op::Catalogue, Status::Ok, w);
+}
+
+void serve_lookup(const Request & req)
+{
+  const string name(req.payload.begin(), req.payload.end());
+  const Correlation * corr_ptr = Correlation::search_by_name(name);
+  if (corr_ptr == nullptr)
+    ZENTHROW(CorrelationNotFound, "correlation " + name + " not found");
+
+  Writer w;
+  w.put(uint32_t(corr_ptr->id));
+  w.put(uint32_t(corr_ptr->get_num_pars()));
+  for (auto it = corr_ptr->get_preconditions().get_it(); it.has_curr();
+       it.next())
+    {
+      const CorrelationPar & par = it.get_curr();
+      w.put(par.min_val.raw());
+      w.put(par.max_val.raw());
+    }
+  req.conn->answer(req.header.id, Op::Lookup, Status::Ok, w);
+}
+
+void serve_eval(const Request & req)
+{
+  Reader r = req.payload;
+  const Correlation * corr_ptr = search_correlation(r.get<uint32_t>());
+  const uint32_t nrows = r.get<uint32_t>();
+  const bool check = r.get<uint32_t>() != 0;
+  const size_t npars = corr_ptr->get_num_pars();
+  if (nrows > (Max_Payload_Size - sizeof(uint32_t))/(sizeof(double) + 1))
+    ZENTHROW(ServerProtocolError, "answer of " + to_string(nrows) +
+	     " rows would exceed the maximum payload size");
+  const vector<double> vals = r.doubles(size_t(nrows)*npars);
+  const double * rows = vals.data();
+
+  vector<double> results(nrows);
+  vector<uint8_t> status(nrows);
+  for (size_t i = 0; i < nrows; ++i, rows += npars)
+    status[i] =
+      evaluate(corr_ptr, rows, check, results[i]) ? Row_Ok : Row_Failed;
+
+  Writer w;
+  w.reserve(sizeof(uint32_t) + nrows*(sizeof(double) + 1));
+  w.put(nrows);
+  w.put(results.data(), nrows);
+  for (auto s : status)
+    w.put(s);
+  req.conn->answer(req.header.id, Op::Eval, Status::Ok, w);
+}
+
+void serve_grid(const Request & req)
+{
+  Reader r = req.payload;
+  const Correlation * corr_ptr = search_correlation(r.get<uint32_t>());
+  const bool check = r.get<uint32_t>() != 0;
+  const size_t npars = corr_ptr->get_num_pars();
+
+  // the answer must fit in a frame
+  const size_t max_rows =
+    min(Max_Grid_Points, (Max_Payload_Size - sizeof(uint32_t))/
+	((npars + 1)*sizeof(double)));
+  vector<double> mins(npars), steps(npars);
+  vector<size_t> ns(npars);
+  size_t nrows = 1;
+  for (size_t j = 0; j < npars; ++j)
+    {
+      const double min = r.get<double>(), max = r.get<double>();
+      const double n = r.get<double>();
+      // the comparisons are false for NaN
+      if (not (n >= 1 and min <= max and isfinite(min) and isfinite(max)))
+	ZENTHROW(ServerProtocolError, "invalid range for parameter " +
+		 to_string(j + 1));
+      // n is checked before converting it, since the conversion of a
+      // double out of the range of size_t is undefined, and nrows
+      // before multiplying it, so that the product cannot overflow
+      if (not (n <= max_rows) or size_t(n) > max_rows/nrows)
+	ZENTHROW(ServerProtocolError, "grid has more than " +
+		 to_string(max_rows) + " points");
+      mins[j] = min;
+      ns[j] = size_t(n);
+      steps[j] = ns[j] > 1 ? (max - min)/(ns[j] - 1) : 0;
+      nrows *= ns[j];
+    }
+
+  Writer w;
+  w.reserve(sizeof(uint32_t) + nrows*(npars + 1)*sizeof(double));
+  w.put(uint32_t(nrows));
+
+  vector<size_t> idx(npars, 0); // odometer over the cartesian product
+  vector<double> row(npars);
+  for (size_t i = 0; i < nrows; ++i)
+    {
+      for (size_t j = 0; j < npars; ++j)
+	row[j] = mins[j] + idx[j]*steps[j];
+      double result;
+      evaluate(corr_ptr, row.data(), check, result);
+      w.put(row.data(), npars);
+      w.put(result);
+
+      for (long j = npars - 1; j >= 0; --j) // last parameter varies faster
+	if (++idx[j] < ns[j])
+	  break;
+	else
+	  idx[j] = 0;
+    }
+
+  req.conn->answer(req.header.id, Op::Grid, Status::Ok, w);
+}
+
+void worker()
+{
+  Request req;
+  while (requests.get(req))
+    {
+      const Op op = static_cast<Op>(req.header.op);
+      try
+	{
+	  switch (op)
+	    {
+	    case Op::Catalogue: serve_catalogue(req); break;
+	    case Op::Lookup: serve_lookup(req); break;
+	    case Op::Eval: serve_eval(req); break;
+	    case Op::Grid: serve_grid(req); break;
+	    default:
+	      ZENTHROW(ServerProtocolError, "unknown operation " +
+		       to_string(req.header.op));
+	    }
+	}
+      catch (exception & e)
+	{
+	  req.conn->answer_error(req.header.id, op, e.what());
+	}
+    }
+}
+
+// Read frames from the connection until the client closes it
+void reader(shared_ptr<Connection> conn)
+{
+  try
+    {
+      while (true)
+	{
+	  Request req;
+	  req.conn = conn;
+	  if (not read_frame(conn->fd, req.header, req.payload))
+	    break;
+	  if (not requests.put(move(req)))
+	    conn->answer(req.header.id, static_cast<Op>(req.header.op),
+			 Status::Busy, Writer());
+	}
+    }
+  catch (exception & e) // malformed frame ==> the stream is lost
+    {
+      if (verbose.getValue())
+	cout << "connection " << conn->fd << ": " << e.what() << endl;
+    }
+
+  if (verbose.getValue())
+    cout << "connection " << conn->fd << " closed" << endl;
+  conn->reader_done = true;
+}
+
+// Reader thread of a connection; the connection is kept so that the
+// reader can be stopped when the server stops
+struct ReaderThread
+{
+  thread th;
+  shared_ptr<Connection> conn;
+};
+
+int listen_on(const string & path)
+{
+  sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path))
+    error_msg("socket path " + path + " is too long");
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    error_msg("cannot create socket: " + string(strerror(errno)));
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  unlink(path.c_str());
+
+  if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    error_msg("cannot bind " + path + ": " + string(strerror(errno)));
+
+  if (listen(fd, SOMAXCONN) < 0)
+    error_msg("cannot listen on " + path + ": " + string(strerror(errno)));
+
+  return fd;
+}
+
+volatile sig_atomic_t stop_requested = 0;
+
+void request_stop(int) { stop_requested = 1; }
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  signal(SIGPIPE, SIG_IGN);
+
+  // without SA_RESTART, so that accept() is interrupted by the signal
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = request_stop;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGINT, &sa, nullptr);
+  sigaction(SIGTERM, &sa, nullptr);
+
+  const size_t n = max<size_t>(num_workers.getValue(), 1);
+  requests.set_capacity(queue_size.getValue());
+
+  // touching the registry here makes it to be built before any request
+  cout << Correlation::num_correlations() << " correlations loaded" << endl;
+
+  const int server_fd = listen_on(socket_path.getValue());
+
+  vector<thread> workers;
+  for (size_t i = 0; i < n; ++i)
+    workers.emplace_back(worker);
+
+  cout << "Listening on " << socket_path.getValue() << " with " << n
+       << " workers" << endl;
+
+  list<ReaderThread> readers;
+  while (not stop_requested)
+    {
+      const int fd = accept(server_fd, nullptr, nullptr);
+      if (fd < 0)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  error_msg("accept failed: " + string(strerror(errno)));
+	}
+
+      if (verbose.getValue())
+	cout << "connection " << fd << " accepted" << endl;
+
+      // join the readers of the connections closed meanwhile
+      for (auto it = readers.begin(); it != readers.end(); )
+	if (it->conn->reader_done)
+	  {
+	    it->th.join();
+	    it = readers.erase(it);
+	  }
+	else
+	  ++it;
+
+      auto conn = make_shared<Connection>(fd);
+      readers.push_back(ReaderThread { thread(reader, conn), conn });
+    }
+
+  close(server_fd);
+  unlink(socket_path.getValue().c_str());
+
+  // a shut down socket reads as closed, but the answers of the queued
+  // requests may still be written
+  for (auto & r : readers)
+    {
+      shutdown(r.conn->fd, SHUT_RD);
+      r.th.join();
+    }
+
+  requests.close();
+  for (auto & w : workers)
+    w.join();
+
+  cout << "Server stopped" << endl;
+}
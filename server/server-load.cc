@@ -0,0 +1,250 @@
+/** Load test client for pvt-server
+
+    Opens several connections to the server and, through each one,
+    pipelines batches of evaluation requests of a correlation with
+    random points sampled inside its declared parameter ranges. At the
+    end it reports the throughput and the latency distribution of the
+    batches.
+
+    Compile and then type
+
+        ./server-load --help
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+
+# include <chrono>
+# include <random>
+# include <thread>
+# include <algorithm>
+
+# include <sys/socket.h>
+# include <sys/un.h>
+
+# include <tclap/CmdLine.h>
+
+# include <utils.H>
+
+# include "protocol.H"
+
+using namespace std;
+using namespace TCLAP;
+using namespace PvtServer;
+
+using Clock = chrono::steady_clock;
+
+CmdLine cmd = { "server-load", ' ', "0" };
+
+ValueArg<string> socket_path = { "s", "socket", "unix socket path", false,
+				 Default_Socket_Path, "socket path", cmd };
+
+ValueArg<string> corr_name = { "C", "correlation", "correlation name", true,
+			       "", "correlation name", cmd };
+
+ValueArg<size_t> num_conns = { "c", "connections", "number of connections",
+			       false, 4, "number of connections", cmd };
+
+ValueArg<size_t> num_batches = { "b", "batches", "batches per connection",
+				 false, 100, "batches per connection", cmd };
+
+ValueArg<size_t> batch_size = { "n", "batch-size", "rows per batch", false,
+				1000, "rows per batch", cmd };
+
+ValueArg<size_t> depth = { "d", "depth", "pipeline depth", false, 8,
+			   "maximum number of in flight requests", cmd };
+
+SwitchArg check = { "", "check", "ask for range verification", cmd };
+
+ValueArg<unsigned long> seed = { "", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+int connect_to(const string & path)
+{
+  sockaddr_un addr;
+  if (path.size() >= sizeof(addr.sun_path))
+    error_msg("socket path " + path + " is too long");
+
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    error_msg("cannot create socket: " + string(strerror(errno)));
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    error_msg("cannot connect to " + path + ": " + string(strerror(errno)));
+
+  return fd;
+}
+
+// Synchronous request; used for the lookup
+vector<char> call(int fd, Op op, const Writer & w)
+{
+  if (not write_frame(fd, 0, op, Status::Ok, w))
+    error_msg("connection lost");
+
+  FrameHeader header;
+  vector<char> payload;
+  if (not read_frame(fd, header, payload))
+    error_msg("connection lost");
+
+  if (header.status != uint16_t(Status::Ok))
+    error_msg(string(payload.begin(), payload.end()));
+
+  return payload;
+}
+
+struct Target
+{
+  uint32_t id = 0;
+  uint32_t npars = 0;
+  vector<pair<double, double>> ranges;
+};
+
+Target lookup(const string & path, const string & name)
+{
+  const int fd = connect_to(path);
+  Writer w;
+  w.put(name);
+  const vector<char> payload = call(fd, Op::Lookup, w);
+  close(fd);
+
+  Reader r = payload;
+  Target ret;
+  ret.id = r.get<uint32_t>();
+  ret.npars = r.get<uint32_t>();
+  for (size_t i = 0; i < ret.npars; ++i)
+    {
+      const double min = r.get<double>();
+      const double max = r.get<double>();
+      ret.ranges.push_back(make_pair(min, max));
+    }
+  return ret;
+}
+
+struct ClientStats
+{
+  size_t rows = 0;
+  size_t failed_rows = 0;
+  size_t busy = 0; // batches refused because the server queue was full
+  vector<double> latencies; // in microseconds
+};
+
+void client(const Target & target, size_t conn_num, ClientStats & stats)
+{
+  const int fd = connect_to(socket_path.getValue());
+  const size_t nbatches = num_batches.getValue();
+  const size_t nrows = batch_size.getValue();
+  const size_t max_in_flight = max<size_t>(depth.getValue(), 1);
+
+  mt19937_64 rng(seed.getValue() + conn_num);
+  vector<uniform_real_distribution<double>> dists;
+  for (const auto & r : target.ranges)
+    dists.emplace_back(r.first, r.second);
+
+  vector<Clock::time_point> sent(nbatches);
+  vector<double> row(target.npars);
+  size_t next = 0, received = 0;
+  FrameHeader header;
+  vector<char> payload;
+  while (received < nbatches)
+    {
+      while (next < nbatches and next - received < max_in_flight)
+	{
+	  Writer w;
+	  w.reserve(3*sizeof(uint32_t) + nrows*target.npars*sizeof(double));
+	  w.put(target.id);
+	  w.put(uint32_t(nrows));
+	  w.put(uint32_t(check.getValue()));
+	  for (size_t i = 0; i < nrows; ++i)
+	    {
+	      for (size_t j = 0; j < target.npars; ++j)
+		row[j] = dists[j](rng);
+	      w.put(row.data(), target.npars);
+	    }
+	  sent[next] = Clock::now();
+	  if (not write_frame(fd, next, Op::Eval, Status::Ok, w))
+	    error_msg("connection lost");
+	  ++next;
+	}
+
+      if (not read_frame(fd, header, payload))
+	error_msg("connection lost");
+      if (header.id >= nbatches)
+	error_msg("unexpected answer id " + to_string(header.id));
+      if (header.status == uint16_t(Status::Busy))
+	{
+	  ++stats.busy;
+	  ++received;
+	  continue;
+	}
+      if (header.status != uint16_t(Status::Ok))
+	error_msg(string(payload.begin(), payload.end()));
+
+      const auto elapsed = Clock::now() - sent[header.id];
+      stats.latencies.push_back
+	(chrono::duration<double, micro>(elapsed).count());
+
+      Reader r = payload;
+      const uint32_t n = r.get<uint32_t>();
+      r.doubles(n);
+      for (size_t i = 0; i < n; ++i)
+	if (r.get<uint8_t>() != Row_Ok)
+	  ++stats.failed_rows;
+      stats.rows += n;
+      ++received;
+    }
+
+  close(fd);
+}
+
+double percentile(const vector<double> & sorted, double q)
+{
+  if (sorted.empty())
+    return 0;
+  const size_t i = min(sorted.size() - 1, size_t(q*sorted.size()));
+  return sorted[i];
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  const Target target = lookup(socket_path.getValue(), corr_name.getValue());
+
+  const size_t n = max<size_t>(num_conns.getValue(), 1);
+  vector<ClientStats> stats(n);
+  vector<thread> clients;
+
+  const auto start = Clock::now();
+  for (size_t i = 0; i < n; ++i)
+    clients.emplace_back(client, cref(target), i, ref(stats[i]));
+  for (auto & t : clients)
+    t.join();
+  const double secs =
+    chrono::duration<double>(Clock::now() - start).count();
+
+  size_t rows = 0, failed = 0, busy = 0;
+  vector<double> latencies;
+  for (const auto & s : stats)
+    {
+      rows += s.rows;
+      failed += s.failed_rows;
+      busy += s.busy;
+      latencies.insert(latencies.end(), s.latencies.begin(), s.latencies.end());
+    }
+  sort(latencies.begin(), latencies.end());
+
+  cout << "correlation       = " << corr_name.getValue() << endl
+       << "connections       = " << n << endl
+       << "batches           = " << latencies.size() << " (" << busy
+       << " refused as busy)" << endl
+       << "rows              = " << rows << " (" << failed << " failed)"
+       << endl
+       << "time              = " << secs << " s" << endl
+       << "throughput        = " << rows/secs << " evaluations/s" << endl
+       << "batch latency p50 = " << percentile(latencies, 0.5) << " us" << endl
+       << "batch latency p90 = " << percentile(latencies, 0.9) << " us" << endl
+       << "batch latency p99 = " << percentile(latencies, 0.99) << " us"
+       << endl;
+}
@@ -37,6 +37,10 @@ constexpr size_t Max_Num_of_Tp_Pairs = 10; // for --tp_pair multiarg
 
 # include <correlations/pvt-correlations.H>
 # include <correlations/defined-correlation.H>
+# include <correlations/correlation-cache-args.H>
+# include <correlations/property-dag.H>
+# include <pvt-monte-carlo.H>
+# include <pvt-grid-compute.H>
 
 using namespace std;
 using namespace TCLAP;
@@ -710,6 +714,8 @@ ValueArg<ColNames> filter_par = { "", "filter", "col names", false, ColNames(),
 ValueArg<size_t> dft_precision = { "", "dft-precision", "default precision value",
 				   false, 6, "default precision value", cmd };
 
+CorrelationCacheArgs cache_args = { cmd };
+
 MultiArg<Digits> digits = { "", "digits", "number of decimal digits", false,
 			    "number of decimal digits", cmd };
 
@@ -1440,6 +1446,134 @@ inline void no_row(const FixedStack<const VtlQuantity*>&,
 
 RowFct row_fct = nullptr;
 
+// Derivatives mode (--derivatives). The rows of an isotherm are
+// buffered and, once the isotherm is complete, they are printed with an
+// additional column d(property)/dp for each property. The derivatives
+// are the slopes of the piecewise linear interpolant in p; that is,
+// the same values that PvtGrid::compute_with_derivatives() returns at
+// the grid nodes
+SwitchArg derivatives_par = { "", "derivatives", "add d/dp columns", cmd };
+bool derivatives = false;
+
+// The values of the rows are allocated in the arena of the thread,
+// which is reset when the isotherm is printed
+struct IsothermRow
+{
+  const char * pb_flag = ""; // quoted flags already separated by comma
+  const char * exc_flag = "";
+  double * vals = nullptr;   // vals[i] corresponds to header column i
+  size_t n = 0;
+};
+
+Array<IsothermRow> isotherm_rows; // rows of current isotherm
+Array<size_t> derivative_cols;    // header indexes of derived columns
+size_t p_col = 0;                 // header index of p
+
+inline void buffer_isotherm_row(const FixedStack<const VtlQuantity*> & row,
+				const FixedStack<Unit_Convert_Fct_Ptr> & row_convert)
+{
+  const size_t n = row.size();
+  const VtlQuantity ** ptr = &row.base();
+
+  IsothermRow r;
+  r.exc_flag = exception_thrown ? "\"true\"," : "\"false\",";
+  exception_thrown = false;
+
+  const Unit_Convert_Fct_Ptr * tgt_unit_ptr = &row_convert.base();
+  r.vals = Arena::local().make_array<double>(n);
+  r.n = n;
+  for (size_t i = 0; i < n; ++i)
+    {
+      Unit_Convert_Fct_Ptr convert_fct = tgt_unit_ptr[i];
+      const VtlQuantity & q = *ptr[i];
+      r.vals[i] = q.is_null() ? Invalid_Value :
+	convert_fct ? convert_fct(q.raw()) : q.raw();
+    }
+
+  isotherm_rows.append(r);
+}
+
+inline void
+buffer_isotherm_row_pb(const FixedStack<const VtlQuantity*> & row,
+		       const FixedStack<Unit_Convert_Fct_Ptr> & row_convert,
+		       bool is_pb)
+{
+  buffer_isotherm_row(row, row_convert);
+  isotherm_rows.get_last().pb_flag = is_pb ? "\"true\"," : "\"false\",";
+}
+
+// Slope of column col at row k. The right segment is preferred; the
+// left one is used for the last row or when the right segment is
+// degenerated (pb and its next double). As in PvtGrid, if an end of
+// that segment is not defined the segment at the other side is used.
+// Return Invalid_Value if the slope cannot be computed
+inline double isotherm_slope(size_t k, size_t col)
+{
+  const size_t n = isotherm_rows.size();
+  if (n < 2)
+    return Invalid_Value;
+
+  auto p = [] (size_t i) { return isotherm_rows(i).vals[p_col]; };
+  auto slope = [&p, col] (size_t i, size_t j)
+    {
+      const double & y1 = isotherm_rows(i).vals[col];
+      const double & y2 = isotherm_rows(j).vals[col];
+      if (y1 == Invalid_Value or y2 == Invalid_Value or p(j) == p(i))
+	return Invalid_Value;
+      return (y2 - y1)/(p(j) - p(i));
+    };
+
+  const bool right = k == 0 or
+    (k < n - 1 and not PvtGrid::degenerated(p(k), p(k + 1)));
+  const double ret = right ? slope(k, k + 1) : slope(k - 1, k);
+  if (ret != Invalid_Value)
+    return ret;
+
+  if (right and k > 0 and not PvtGrid::degenerated(p(k - 1), p(k)))
+    return slope(k - 1, k);
+  if (not right and k < n - 1 and not PvtGrid::degenerated(p(k), p(k + 1)))
+    return slope(k, k + 1);
+  return Invalid_Value;
+}
+
+// Print the buffered rows of the current isotherm and clear the buffer
+void print_isotherm()
+{
+  const size_t nrow = isotherm_rows.size();
+  for (size_t k = 0; k < nrow; ++k)
+    {
+      const IsothermRow & r = isotherm_rows(k);
+      printf("%s%s", r.pb_flag, r.exc_flag);
+      for (long i = r.n - 1; i >= 0; --i)
+	{
+	  if (r.vals[i] != Invalid_Value)
+	    printf(precisions(i), r.vals[i]);
+	  if (i > 0)
+	    printf(",");
+	}
+
+      for (auto it = derivative_cols.get_it(); it.has_curr(); it.next())
+	{
+	  const size_t col = it.get_curr();
+	  const double slope = isotherm_slope(k, col);
+	  printf(",");
+	  if (slope != Invalid_Value)
+	    printf("%g", slope);
+	}
+      printf("\n");
+    }
+
+  isotherm_rows.empty();
+  Arena::local().reset();
+}
+
+// Must be called by the grid generators when an isotherm is finished
+inline void end_isotherm()
+{
+  if (derivatives)
+    print_isotherm();
+}
+
 // Print out the csv header according to passed args and return a
 // stack of definitive units for each column. Also it sets row_fct
 template <typename ... Args>
@@ -1516,6 +1650,29 @@ FixedStack<Unit_Convert_Fct_Ptr> print_csv_header(Args ... args)
       row_fct_pb = &buffer_row_pb;
       row_fct = &buffer_row;
     }
+  else if (derivatives)
+    {
+      for (long i = n - 1; i >= 0; --i)
+	{
+	  const pair<string, const Unit*> & val = col_ptr[i];
+	  printf("%s %s", val.first.c_str(), final_units[i]->name.c_str());
+	  if (i > 0)
+	    printf(",");
+	  if (val.first == "p")
+	    p_col = i;
+	  else if (val.first != "t" and final_units[i] != &Unit::null_unit)
+	    derivative_cols.append(i);
+	}
+      for (auto it = derivative_cols.get_it(); it.has_curr(); it.next())
+	{
+	  const size_t i = it.get_curr();
+	  printf(",d%s_dp %s/%s", col_ptr[i].first.c_str(),
+		 final_units[i]->name.c_str(), p_unit->name.c_str());
+	}
+      printf("\n");
+      row_fct_pb = &buffer_isotherm_row_pb;
+      row_fct = &buffer_isotherm_row;
+    }
   else if (filter_par.isSet())
     {
       const size_t & n = col_indexes.size();
@@ -1653,282 +1810,279 @@ void print_notranspose()
     }
 }
 
-# define Blackoil_Init()						\
-  set_api(); /* Initialization of constant data */			\
-  set_rsb();								\
-  set_yg();								\
-  set_tsep();								\
-  set_psep();								\
-  set_h2s();								\
-  set_co2();								\
-  set_n2();								\
-  set_nacl();								\
-									\
-  set_pb_corr(); /* Initialization of correlations */			\
-  set_rs_corr();							\
-  set_bob_corr();							\
-  set_boa_corr();							\
-  set_uod_corr();							\
-  set_cob_corr();							\
-  set_coa_corr();							\
-  set_uob_corr();							\
-  set_uoa_corr();							\
-  set_ppchc_corr();							\
-  set_tpchc_corr();							\
-  set_ppcm_mixing_corr();						\
-  set_tpcm_mixing_corr();						\
-  set_adjustedppcm_corr();						\
-  set_adjustedtpcm_corr();						\
-  set_zfactor_corr();							\
-  set_cg_corr();							\
-  set_ug_corr();							\
-  set_bwb_corr();							\
-  set_bwa_corr();							\
-  set_uw_corr();							\
-  set_pw_corr();							\
-  set_rsw_corr();							\
-  set_cwb_corr();							\
-  set_cwa_corr();							\
-  set_sgo_corr();							\
-  set_sgw_corr();							\
-									\
-  const double & c_pb = c_pb_arg.getValue();				\
-  const double & m_pb = m_pb_arg.getValue();				\
-  const double & c_z = c_zfactor_arg.getValue();			\
-  const double & m_z = m_zfactor_arg.getValue();			\
-  									\
-  pressure = get<2>(p_values.get_first());				\
-									\
-  /* Calculation of constants for Z */					\
-  auto yghc = compute_exc(YghcWichertAziz::correlation(), true, NPAR(yg), \
-			  NPAR(n2), NPAR(co2), NPAR(h2s));		\
-  auto ppchc = compute_exc(ppchc_corr, true, NPAR(yghc),		\
-			   NPAR(n2), NPAR(co2), NPAR(h2s));		\
-  auto ppcm = compute_exc(ppcm_mixing_corr, true, NPAR(ppchc),		\
-			  NPAR(n2), NPAR(co2), NPAR(h2s));		\
-  auto tpchc = tpchc_corr->compute(check, yghc);			\
-  auto tpcm = compute_exc(tpcm_mixing_corr, true, NPAR(tpchc),		\
-			  NPAR(n2), NPAR(co2), NPAR(h2s));		\
-  auto adjustedppcm = compute_exc(adjustedppcm_corr, true, NPAR(ppcm),	\
-				  NPAR(tpcm), NPAR(co2), NPAR(h2s));	\
-  auto adjustedtpcm = compute_exc(adjustedtpcm_corr, true, NPAR(tpcm),	\
-				  NPAR(co2), NPAR(h2s));		\
-  /* End calculation constants for z */					\
-									\
-  /* Initialization of correlation parameter lists */			\
-  auto pb_pars = load_constant_parameters({pb_corr});			\
-  auto rs_pars = load_constant_parameters({rs_corr,			\
-	&RsAbovePb::get_instance()});					\
-  auto uod_pars = load_constant_parameters({uod_corr});			\
-  auto bo_pars = load_constant_parameters({bob_corr, boa_corr});	\
-  auto co_pars = load_constant_parameters({cob_corr, coa_corr});	\
-  auto uo_pars = load_constant_parameters({uob_corr, uoa_corr});	\
-  auto po_pars = load_constant_parameters({&PobBradley::get_instance(),	\
-	&PoaBradley::get_instance()});					\
-  auto ug_pars = load_constant_parameters({ug_corr});			\
-  insert_in_container(ug_pars, npar("tpc", adjustedtpcm),		\
-		      npar("ppc", adjustedppcm));			\
-  auto bw_pars = load_constant_parameters({bwb_corr, bwa_corr});	\
-  auto uw_pars = load_constant_parameters({uw_corr});			\
-  auto pw_pars = load_constant_parameters({pw_corr});			\
-  auto rsw_pars = load_constant_parameters({rsw_corr});			\
-  auto cw_pars = load_constant_parameters({cwb_corr, cwa_corr});	\
-  auto cwa_pars = load_constant_parameters({cwa_corr});			\
-  ParList cg_pars; cg_pars.insert(npar("ppc", ppcm));			\
-  auto sgo_pars = load_constant_parameters({sgo_corr});			\
-  ParList sgw_pars;							\
-									\
-  using P = pair<string, const Unit*>;					\
-  auto row_units =							\
-	     print_csv_header(P("t", t_unit),				\
-			      P("pb", &pb_corr->unit),			\
-			      P("uod", &uod_corr->unit),		\
-			      P("p", p_unit),				\
-			      P("rs", &::rs_corr->unit),		\
-			      P("co", &cob_corr->unit),			\
-			      P("bo", &bob_corr->unit),			\
-			      P("uo", &uob_corr->unit),			\
-			      P("po", &PobBradley::get_instance().unit), \
-			      P("zfactor", &Zfactor::get_instance()),	\
-			      P("cg", &cg_corr->unit),			\
-			      P("bg", &Bg::get_instance().unit),	\
-			      P("ug", &ug_corr->unit),			\
-			      P("pg", &Pg::get_instance().unit),	\
-			      P("bw", &bwb_corr->unit),			\
-			      P("uw", &uw_corr->unit),			\
-			      P("pw", &pw_corr->unit),			\
-			      P("rsw", &rsw_corr->unit),		\
-			      P("cw", &cwb_corr->unit),			\
-			      P("sgo", &sgo_corr->unit),		\
-			      P("sgw", &sgw_corr->unit),		\
-			      P("exception", &Unit::null_unit),		\
-			      P("pbrow", &Unit::null_unit));		\
-									\
-  auto rs_pb = npar("rs", rsb_par);					\
-									\
-  /* Here are the values. Ensure that the insertion order is the same*/	\
-  /* as for the csv header temperature loop */				\
-									\
-  FixedStack<const VtlQuantity*> row(25); 
+// Number of threads used for evaluating the independent branches of
+// the property graph (oil, gas and water) of every isotherm
+ValueArg<size_t> threads_arg =
+  { "", "threads", "threads for evaluating independent properties", false, 1,
+    "number of threads", cmd };
 
-# define Blackoil_Temperature_Calculations()				\
-  VtlQuantity t_q = par(t_par);						\
-  temperature = t_q.raw();						\
-  CALL(Tpr, tpr, t_q, adjustedtpcm);					\
-  auto tpr_par = NPAR(tpr);						\
-									\
-  VtlQuantity pb_q = tcompute(pb_corr, c_pb, m_pb, *pb_unit, check,	\
-			      pb_pars, t_par);				\
-  if (pb_q.is_null())							\
-    continue;								\
-  auto pb_par = npar("pb", pb_q);					\
-  auto p_pb = npar("p", pb_q);						\
-									\
-  auto uod_val = tcompute(uod_corr, c_uod_arg.getValue(),		\
-			  m_uod_arg.getValue(), *uo_unit, check,	\
-			  uod_pars, t_par, pb_par);			\
-									\
-  insert_in_container(rs_pars, t_par, pb_par);				\
-  auto rs_corr = define_correlation(pb_q, ::rs_corr, c_rs_arg.getValue(), \
-				    m_rs_arg.getValue(), *rs_unit,	\
-				    &RsAbovePb::get_instance(), 0, 1,	\
-				    *rs_unit);				\
-									\
-  insert_in_container(co_pars, t_par, pb_par);				\
-  auto co_corr = define_correlation(pb_q, cob_corr, c_cob_arg.getValue(), \
-				    m_cob_arg.getValue(), *co_unit,	\
-				    coa_corr, c_coa_arg.getValue(),	\
-				    m_coa_arg.getValue(), *co_unit);	\
-  auto bo_corr = define_correlation(pb_q, bob_corr, c_bob_arg.getValue(),\
-				    m_bob_arg.getValue(), *bo_unit,	\
-				    boa_corr, c_boa_arg.getValue(),	\
-				    m_boa_arg.getValue(), *bo_unit);	\
-									\
-  insert_in_container(uo_pars, t_par, pb_par, npar("uod", uod_val));	\
-  auto uo_corr = define_correlation(pb_q, uob_corr, c_uob_arg.getValue(), \
-				    m_uob_arg.getValue(), *uo_unit,	\
-				    uoa_corr, c_uoa_arg.getValue(),	\
-				    m_uoa_arg.getValue(), *uo_unit);	\
-  									\
-  auto po_corr = define_correlation(pb_q, &PobBradley::get_instance(),	\
-				    &PoaBradley::get_instance());	\
-									\
-  auto bw_corr = define_correlation(pb_q, bwb_corr, bwa_corr);		\
-									\
-  auto cw_corr = define_correlation(pb_q, cwb_corr, cwa_corr);		\
-									\
-  insert_in_container(bo_pars, t_par, pb_par);				\
-  auto bobp = tcompute(bob_corr, c_bob_arg.getValue(), m_bob_arg.getValue(), \
-		       *bo_unit, check, bo_pars, p_pb, rs_pb);		\
-									\
-  auto uobp = tcompute(uob_corr, c_uob_arg.getValue(), m_uob_arg.getValue(), \
-		       *uo_unit, check,					\
-		       uo_pars, p_pb, rs_pb, npar("bob", bobp));	\
-									\
-  bo_pars.insert(NPAR(bobp));						\
-									\
-  uo_pars.insert("uobp", uobp.raw(), &uobp.unit);			\
-									\
-  auto pobp = compute(&PobBradley::get_instance(), check, po_pars,	\
-		      rs_pb, npar("bob", bobp));			\
-									\
-  auto bwbp = compute(bwb_corr, check, bw_pars, t_par, npar("p", pb_q)); \
-									\
-  insert_in_container(po_pars, pb_par, NPAR(pobp));			\
-  insert_in_container(ug_pars, t_par, tpr_par);				\
-  insert_in_container(bw_pars, t_par, pb_par, NPAR(bwbp));		\
-  cg_pars.insert(tpr_par);						\
-  uw_pars.insert(t_par);						\
-  pw_pars.insert(t_par);						\
-  rsw_pars.insert(t_par);						\
-  cw_pars.insert(t_par);						\
-  cwa_pars.insert(t_par);						\
-  sgo_pars.insert(t_par);						\
-  sgw_pars.insert(t_par);						\
-									\
-  size_t n = insert_in_row(row, t_q, pb_q, uod_val);
+// save an error reported by a PropertyDag. As with the former
+// wrappers, correlation errors are only saved if report_exceptions is
+// set, while errors of direct calls are always saved
+void store_exception(const PropertyDag::Error & e)
+{
+  if (not (report_exceptions or e.function))
+    return;
+  exception_thrown = true;
+  ostringstream s;
+  s << e.name << ": " << temperature << " " << t_unit->name << ", "
+    << pressure << " " << p_unit->name << ": " << e.msg << endl;
+  exception_list.append(s.str());
+}
 
-# define Blackoil_Pressure_Calculations()				\
-  pressure = p_q.raw();							\
-  CALL(Ppr, ppr, p_q, adjustedppcm);					\
-  auto ppr_par = NPAR(ppr);						\
-  auto rs = dcompute(rs_corr, check, p_q, rs_pars, p_par);		\
-  rs = min(rs, rsb);							\
-  auto rs_par = NPAR(rs);						\
-  auto coa = dcompute(co_corr, check, p_q, co_pars, p_par);		\
-  auto coa_par = NPAR(coa);						\
-  auto bo = dcompute(bo_corr, check, p_q, bo_pars, p_par, rs_par,	\
-		     coa_par);						\
-  auto uo = dcompute(uo_corr, check, p_q, uo_pars, p_par, rs_par,	\
-		     npar("bob", bo));					\
-  auto po = dcompute(po_corr, check, p_q, po_pars, p_par, rs_par, coa_par, \
-		     npar("bob", bo));					\
-  VtlQuantity z;							\
-  if (p_q <= pb_q)							\
-    z = tcompute(zfactor_corr, c_z, m_z, *z_unit, check, ppr_par, tpr_par); \
-  auto z_par = NPAR(z);							\
-  auto cg = compute(cg_corr, check, cg_pars, ppr_par, z_par);		\
-  CALL(Bg, bg, t_q, p_q, z);						\
-  auto ug = compute(ug_corr, check, ug_pars, p_par, ppr_par, z_par);	\
-  CALL(Pg, pg, yg, t_q, p_q, z);					\
-  auto rsw = compute(rsw_corr, check, rsw_pars, p_par);			\
-  auto rsw_par = NPAR(rsw);						\
-  auto cwa = compute(cwa_corr, check, cwa_pars, p_par, rsw_par);	\
-  auto bw = dcompute(bw_corr, check, p_q, bw_pars, p_par, NPAR(cwa));	\
-  auto bw_par = NPAR(bw);						\
-  auto pw = compute(pw_corr, check, pw_pars, p_par, bw_par);		\
-  auto cw = dcompute(cw_corr, check, p_q, cw_pars, p_par, z_par,	\
-		     NPAR(bg), rsw_par, bw_par, NPAR(cwa));		\
-  CALL(PpwSpiveyMN, ppw, t_q, p_q);					\
-  auto uw = compute(uw_corr, check, uw_pars, p_par, NPAR(ppw));		\
-  auto sgo = compute(sgo_corr, check, sgo_pars, p_par);			\
-  auto sgw = compute(sgw_corr, check, sgw_pars, p_par);			\
-									\
-  size_t n = insert_in_row(row, p_q, rs, coa, bo, uo, po, z, cg, bg,	\
-			   ug, pg, bw, uw, pw, rsw, cw, sgo, sgw);	\
-									\
-  assert(row.size() == 21);
+inline void store_exceptions(const DynList<PropertyDag::Error> & errors)
+{
+  errors.for_each([] (const auto & e) { store_exception(e); });
+}
+
+// Append to row the values of frame indexed by cols
+inline size_t insert_in_row(FixedStack<const VtlQuantity*> & row,
+			    const PropertyDag::Frame & frame,
+			    const Array<size_t> & cols)
+{
+  for (auto it = cols.get_it(); it.has_curr(); it.next())
+    row.insert(&frame.vals(it.get_curr()));
+  return cols.size();
+}
+
+// Property graph of a black oil. Besides the properties reported in
+// the grid, it contains the constants for z and the values at pb
+// (bobp, uobp, pobp and bwbp) required by the correlations above pb
+PropertyDag build_blackoil_dag()
+{
+  set_api(); /* Initialization of constant data */
+  set_rsb();
+  set_yg();
+  set_tsep();
+  set_psep();
+  set_h2s();
+  set_co2();
+  set_n2();
+  set_nacl();
+
+  set_pb_corr(); /* Initialization of correlations */
+  set_rs_corr();
+  set_bob_corr();
+  set_boa_corr();
+  set_uod_corr();
+  set_cob_corr();
+  set_coa_corr();
+  set_uob_corr();
+  set_uoa_corr();
+  set_ppchc_corr();
+  set_tpchc_corr();
+  set_ppcm_mixing_corr();
+  set_tpcm_mixing_corr();
+  set_adjustedppcm_corr();
+  set_adjustedtpcm_corr();
+  set_zfactor_corr();
+  set_cg_corr();
+  set_ug_corr();
+  set_bwb_corr();
+  set_bwa_corr();
+  set_uw_corr();
+  set_pw_corr();
+  set_rsw_corr();
+  set_cwb_corr();
+  set_cwa_corr();
+  set_sgo_corr();
+  set_sgw_corr();
+
+  using Piece = PropertyDag::Piece;
+  using Args = PropertyDag::Args;
+  using R = pair<string, string>;
+
+  PropertyDag dag(check);
+  dag.set_num_threads(threads_arg.getValue());
+
+  for (auto & par : { api_par, rsb_par, yg_par, tsep_par, psep_par,
+	h2s_par, co2_par, n2_par, nacl_par })
+    dag.add_constant(par);
+
+  /* Constants for Z */
+  dag.add_correlation("yghc", YghcWichertAziz::correlation());
+  dag.add_correlation("ppchc", ppchc_corr);
+  dag.add_correlation("ppcm", ppcm_mixing_corr);
+  dag.add_correlation("tpchc", tpchc_corr);
+  dag.add_correlation("tpcm", tpcm_mixing_corr);
+  dag.add_correlation("adjustedppcm", adjustedppcm_corr);
+  dag.add_correlation("adjustedtpcm", adjustedtpcm_corr);
+
+  /* Temperature dependent */
+  dag.add_function("tpr", { "t", "adjustedtpcm" }, [] (const Args & a)
+    {
+      return Tpr::get_instance().call(a(0), a(1));
+    }, Tpr::get_instance().name);
+  dag.add_tuned_correlation("pb", pb_corr, c_pb_arg.getValue(),
+			    m_pb_arg.getValue(), *pb_unit);
+  dag.add_tuned_correlation("uod", uod_corr, c_uod_arg.getValue(),
+			    m_uod_arg.getValue(), *uo_unit);
+  dag.add_tuned_correlation("bobp", bob_corr, c_bob_arg.getValue(),
+			    m_bob_arg.getValue(), *bo_unit,
+			    { R("p", "pb"), R("rs", "rsb") });
+  dag.add_tuned_correlation("uobp", uob_corr, c_uob_arg.getValue(),
+			    m_uob_arg.getValue(), *uo_unit,
+			    { R("p", "pb"), R("rs", "rsb"), R("bob", "bobp") });
+  dag.add_correlation("pobp", &PobBradley::get_instance(),
+		      { R("rs", "rsb"), R("bob", "bobp") });
+  dag.add_correlation("bwbp", bwb_corr, { R("p", "pb") });
+
+  /* Oil */
+  dag.add_split("rs_raw",
+		Piece(::rs_corr, c_rs_arg.getValue(), m_rs_arg.getValue(),
+		      *rs_unit),
+		Piece(&RsAbovePb::get_instance(), 0, 1, *rs_unit));
+  dag.add_function("rs", { "rs_raw", "rsb" }, [] (const Args & a)
+    {
+      return min(a(0), a(1));
+    });
+  dag.add_split("coa",
+		Piece(cob_corr, c_cob_arg.getValue(), m_cob_arg.getValue(),
+		      *co_unit),
+		Piece(coa_corr, c_coa_arg.getValue(), m_coa_arg.getValue(),
+		      *co_unit));
+  dag.add_split("bo",
+		Piece(bob_corr, c_bob_arg.getValue(), m_bob_arg.getValue(),
+		      *bo_unit),
+		Piece(boa_corr, c_boa_arg.getValue(), m_boa_arg.getValue(),
+		      *bo_unit));
+  dag.add_split("uo",
+		Piece(uob_corr, c_uob_arg.getValue(), m_uob_arg.getValue(),
+		      *uo_unit),
+		Piece(uoa_corr, c_uoa_arg.getValue(), m_uoa_arg.getValue(),
+		      *uo_unit),
+		{ R("bob", "bo") });
+  dag.add_split("po", &PobBradley::get_instance(), &PoaBradley::get_instance(),
+		{ R("bob", "bo") });
+
+  /* Gas */
+  dag.add_function("ppr", { "p", "adjustedppcm" }, [] (const Args & a)
+    {
+      return Ppr::get_instance().call(a(0), a(1));
+    }, Ppr::get_instance().name);
+  dag.add_tuned_correlation("z", zfactor_corr, c_zfactor_arg.getValue(),
+			    m_zfactor_arg.getValue(), *z_unit);
+  dag.add_guard("z", { "p", "pb" }, [] (const Args & a)
+    {
+      return a(0) <= a(1);
+    });
+  dag.add_correlation("cg", cg_corr, { R("ppc", "ppcm") });
+  dag.add_function("bg", { "t", "p", "z" }, [] (const Args & a)
+    {
+      return Bg::get_instance().call(a(0), a(1), a(2));
+    }, Bg::get_instance().name);
+  dag.add_correlation("ug", ug_corr,
+		      { R("tpc", "adjustedtpcm"), R("ppc", "adjustedppcm") });
+  dag.add_function("pg", { "yg", "t", "p", "z" }, [] (const Args & a)
+    {
+      return Pg::get_instance().call(a(0), a(1), a(2), a(3));
+    }, Pg::get_instance().name);
+
+  /* Water */
+  dag.add_correlation("rsw", rsw_corr);
+  dag.add_correlation("cwa", cwa_corr);
+  dag.add_split("bw", bwb_corr, bwa_corr);
+  dag.add_correlation("pw", pw_corr);
+  dag.add_split("cw", cwb_corr, cwa_corr);
+  dag.add_function("ppw", { "t", "p" }, [] (const Args & a)
+    {
+      return PpwSpiveyMN::get_instance().call(a(0), a(1));
+    }, PpwSpiveyMN::get_instance().name);
+  dag.add_correlation("uw", uw_corr);
+  dag.add_correlation("sgo", sgo_corr);
+  dag.add_correlation("sgw", sgw_corr);
 
-# define Blackoil_Pop_Temperature_Parameters()			\
-  row.popn(n);							\
-  remove_from_container(rs_pars, "pb", t_par);			\
-  remove_from_container(co_pars, "pb", t_par);			\
-  remove_from_container(bo_pars, "bobp", "pb", t_par);		\
-  remove_from_container(uo_pars, "uobp", "pb", "uod", t_par);	\
-  remove_from_container(po_pars, "pb", "pobp");			\
-  remove_from_container(ug_pars, t_par, tpr_par);		\
-  remove_from_container(bw_pars, t_par, pb_par, "bwbp");	\
-  sgo_pars.remove(t_par);					\
-  sgw_pars.remove(t_par);					\
-  cg_pars.remove(tpr_par);					\
-  uw_pars.remove(t_par);					\
-  pw_pars.remove(t_par);					\
-  cw_pars.remove(t_par);					\
-  rsw_pars.remove(t_par);
+  pressure = get<2>(p_values.get_first());
+  dag.compile();
+
+  auto errors = dag.constants().errors;
+  if (not errors.is_empty())
+    {
+      const auto & e = errors.get_first();
+      cout << "ERROR initializing " << e.name << "@ " << e.msg;
+      abort();
+    }
+
+  return dag;
+}
+
+FixedStack<Unit_Convert_Fct_Ptr> print_blackoil_header()
+{
+  using P = pair<string, const Unit*>;
+  return print_csv_header(P("t", t_unit),
+			  P("pb", &pb_corr->unit),
+			  P("uod", &uod_corr->unit),
+			  P("p", p_unit),
+			  P("rs", &::rs_corr->unit),
+			  P("co", &cob_corr->unit),
+			  P("bo", &bob_corr->unit),
+			  P("uo", &uob_corr->unit),
+			  P("po", &PobBradley::get_instance().unit),
+			  P("zfactor", &Zfactor::get_instance()),
+			  P("cg", &cg_corr->unit),
+			  P("bg", &Bg::get_instance().unit),
+			  P("ug", &ug_corr->unit),
+			  P("pg", &Pg::get_instance().unit),
+			  P("bw", &bwb_corr->unit),
+			  P("uw", &uw_corr->unit),
+			  P("pw", &pw_corr->unit),
+			  P("rsw", &rsw_corr->unit),
+			  P("cw", &cwb_corr->unit),
+			  P("sgo", &sgo_corr->unit),
+			  P("sgw", &sgw_corr->unit),
+			  P("exception", &Unit::null_unit),
+			  P("pbrow", &Unit::null_unit));
+}
+
+// dag indexes of the temperature and pressure columns in the order of
+// the csv header
+void blackoil_columns(const PropertyDag & dag,
+		      Array<size_t> & t_cols, Array<size_t> & p_cols)
+{
+  for (auto & name : { "t", "pb", "uod" })
+    t_cols.append(dag.index(name));
+  for (auto & name : { "p", "rs", "coa", "bo", "uo", "po", "z", "cg", "bg",
+	"ug", "pg", "bw", "uw", "pw", "rsw", "cw", "sgo", "sgw" })
+    p_cols.append(dag.index(name));
+}
 
 void generate_grid_blackoil()
 {
-  Blackoil_Init();
+  PropertyDag dag = build_blackoil_dag();
+  auto row_units = print_blackoil_header();
+  Array<size_t> t_cols, p_cols;
+  blackoil_columns(dag, t_cols, p_cols);
+  const size_t pb_idx = dag.index("pb");
 
-  for (auto t_it = t_values.get_it(); t_it.has_curr(); t_it.next()) 
+  FixedStack<const VtlQuantity*> row(25);
+
+  for (auto t_it = t_values.get_it(); t_it.has_curr(); t_it.next())
     {
-      Correlation::NamedPar t_par = t_it.get_curr();
-      Blackoil_Temperature_Calculations();
+      VtlQuantity t_q = par(t_it.get_curr());
+      temperature = t_q.raw();
+      auto tframe = dag.eval_temperature(t_q);
+      store_exceptions(tframe.errors);
+
+      const VtlQuantity & pb_q = tframe.vals(pb_idx);
+      if (pb_q.is_null())
+	continue;
+
       auto pb = pb_q.raw();
       double next_pb = nextafter(pb, numeric_limits<double>::max());
       VtlQuantity next_pb_q = { pb_q.unit, next_pb };
 
       auto first_p_point = p_values.get_first();
       bool first_p_above_pb = VtlQuantity(*get<3>(first_p_point),
-					  get<2>(first_p_point)) > pb_q; 
+					  get<2>(first_p_point)) > pb_q;
 
+      Array<VtlQuantity> ps;
+      Array<bool> pb_rows;
       size_t i = 0;
       for (auto p_it = p_values.get_it(); p_it.has_curr(); ) // pressure loop
 	{
-	  Correlation::NamedPar p_par = p_it.get_curr();
-	  VtlQuantity p_q = par(p_par);
+	  VtlQuantity p_q = par(p_it.get_curr());
 
-	  bool pb_row = false; /* true if this line concerns to bubble point */	
+	  bool pb_row = false; /* true if this line concerns to bubble point */
 
 	  /* WARNING: these predicates must be evaluated exactly in
 	     this order */
@@ -1937,39 +2091,232 @@ void generate_grid_blackoil()
 	  else
 	    {
 	      pb_row = true;
-	      p_par = npar("p", ++i == 1 ? pb_q : next_pb_q);
-	      p_q = par(p_par);
+	      p_q = ++i == 1 ? pb_q : next_pb_q;
 	      assert(i <= 2);
-	    }		
+	    }
+	  ps.append(p_q);
+	  pb_rows.append(pb_row);
+	}
 
-	  Blackoil_Pressure_Calculations();
-	  row_fct_pb(row, row_units, pb_row);
-	  row.popn(n);
+      auto frames = dag.eval_pressures(tframe, ps);
+
+      size_t n = insert_in_row(row, tframe, t_cols);
+      for (size_t k = 0; k < frames.size(); ++k)
+	{
+	  pressure = ps(k).raw();
+	  store_exceptions(frames(k).errors);
+	  size_t m = insert_in_row(row, frames(k), p_cols);
+	  row_fct_pb(row, row_units, pb_rows(k));
+	  row.popn(m);
 	}
-      Blackoil_Pop_Temperature_Parameters();
+      row.popn(n);
+      end_isotherm();
     }
 }
 
 void generate_rows_blackoil()
 {
   assert(not tp_values.is_empty());
- 
-  Blackoil_Init();
+
+  PropertyDag dag = build_blackoil_dag();
+  auto row_units = print_blackoil_header();
+  Array<size_t> t_cols, p_cols;
+  blackoil_columns(dag, t_cols, p_cols);
+  const size_t pb_idx = dag.index("pb");
+
+  FixedStack<const VtlQuantity*> row(25);
+
   for (auto it = tp_values.get_it(); it.has_curr(); it.next())
     {
       auto & curr = it.get_curr();
-      Correlation::NamedPar t_par = curr.first;
-      Correlation::NamedPar p_par = curr.second;
-      Blackoil_Temperature_Calculations();
+      VtlQuantity t_q = par(curr.first);
+      temperature = t_q.raw();
+      auto tframe = dag.eval_temperature(t_q);
+      store_exceptions(tframe.errors);
+      if (tframe.vals(pb_idx).is_null())
+	continue;
+
+      Array<VtlQuantity> ps;
+      ps.append(par(curr.second));
+      pressure = ps(0).raw();
+      auto frames = dag.eval_pressures(tframe, ps);
+      store_exceptions(frames(0).errors);
+
+      size_t n = insert_in_row(row, tframe, t_cols);
+      n += insert_in_row(row, frames(0), p_cols);
+      row_fct_pb(row, row_units, false);
+      row.popn(n);
+    }
+}
+
+// Monte Carlo mode (--mc-samples). Every --mc-input "par distribution
+// params" replaces the constant par of the black oil graph by one of
+// the distributions of McDistribution::parse(); the parameters are in
+// the unit of par and the samples are truncated to the unit range.
+// For every node (t, p) of the grid and every property it prints the
+// P10, P50 and P90 of the realisations. Since pb changes from one
+// realisation to another, the pb rows are not generated
+ValueArg<size_t> mc_samples_arg =
+  { "", "mc-samples", "Monte Carlo realisations (0 disables)", false, 0,
+    "number of realisations", cmd };
+
+MultiArg<string> mc_input_arg =
+  { "", "mc-input", "uncertain input for Monte Carlo", false,
+    "\"par distribution params\"", cmd };
+
+ValueArg<unsigned long> mc_seed_arg =
+  { "", "mc-seed", "seed of Monte Carlo", false, 0, "seed", cmd };
 
-      VtlQuantity p_q = par(p_par);
+ValueArg<size_t> mc_batch_arg =
+  { "", "mc-batch", "realisations evaluated before updating the percentiles"
+    " (0 means 4 per thread)", false, 0, "batch size", cmd };
+
+void generate_monte_carlo_blackoil()
+{
+  const size_t num_threads = max<size_t>(threads_arg.getValue(), 1);
+
+  // a graph per worker; each one is evaluated by a single thread
+  vector<PropertyDag> dags;
+  dags.reserve(num_threads);
+  for (size_t w = 0; w < num_threads; ++w)
+    {
+      dags.push_back(build_blackoil_dag());
+      dags.back().set_num_threads(1);
+    }
+
+  MonteCarlo mc(mc_seed_arg.getValue());
+  mc.set_num_threads(num_threads);
+  mc.set_batch_size(mc_batch_arg.getValue());
+
+  const Correlation::NamedPar * constants[] =
+    { &api_par, &rsb_par, &yg_par, &tsep_par, &psep_par, &h2s_par, &co2_par,
+      &n2_par, &nacl_par };
+  Array<const Unit*> input_units;
+  for (auto & str : mc_input_arg.getValue())
+    {
+      istringstream s(str);
+      string name, dist;
+      s >> name;
+      getline(s, dist);
+      auto ptr = find_if(begin(constants), end(constants),
+			 [&name] (auto p) { return get<1>(*p) == name; });
+      if (ptr == end(constants))
+	ZENTHROW(CommandLineError, "in --mc-input: " + name +
+		 " is not an input constant");
+      const Unit & unit = *get<3>(**ptr);
+      try
+	{
+	  McDistribution d = McDistribution::parse(dist);
+	  d.lo = unit.min();
+	  d.hi = unit.max();
+	  mc.add_input(name, d);
+	}
+      catch (exception & e)
+	{
+	  ZENTHROW(CommandLineError, "in --mc-input \"" + str + "\": " +
+		   e.what());
+	}
+      input_units.append(&unit);
+    }
+
+  using P = pair<string, const Unit*>;
+  const DynList<pair<string, P>> props =
+    { { "pb", P("pb", &pb_corr->unit) },
+      { "uod", P("uod", &uod_corr->unit) },
+      { "rs", P("rs", &::rs_corr->unit) },
+      { "coa", P("co", &cob_corr->unit) },
+      { "bo", P("bo", &bob_corr->unit) },
+      { "uo", P("uo", &uob_corr->unit) },
+      { "po", P("po", &PobBradley::get_instance().unit) },
+      { "z", P("zfactor", &Zfactor::get_instance()) },
+      { "cg", P("cg", &cg_corr->unit) },
+      { "bg", P("bg", &Bg::get_instance().unit) },
+      { "ug", P("ug", &ug_corr->unit) },
+      { "pg", P("pg", &Pg::get_instance().unit) },
+      { "bw", P("bw", &bwb_corr->unit) },
+      { "uw", P("uw", &uw_corr->unit) },
+      { "pw", P("pw", &pw_corr->unit) },
+      { "rsw", P("rsw", &rsw_corr->unit) },
+      { "cw", P("cw", &cwb_corr->unit) },
+      { "sgo", P("sgo", &sgo_corr->unit) },
+      { "sgw", P("sgw", &sgw_corr->unit) } };
+
+  FixedStack<P> header(props.size() + 2);
+  header.insert(P("t", t_unit));
+  header.insert(P("p", p_unit));
+  Array<size_t> prop_idx;
+  for (auto it = props.get_it(); it.has_curr(); it.next())
+    {
+      prop_idx.append(dags[0].index(it.get_curr().first));
+      header.insert(it.get_curr().second);
+    }
+  auto units = build_stack_of_property_units(header);
+  const Unit ** final_units = &units.first.base();
+  const Unit_Convert_Fct_Ptr * fcts = &units.second.base();
+
+  Array<VtlQuantity> ts, ps;
+  t_values.for_each([&ts] (const auto & t) { ts.append(par(t)); });
+  p_values.for_each([&ps] (const auto & p) { ps.append(par(p)); });
+  const size_t nt = ts.size(), np = ps.size(), nprops = prop_idx.size();
+
+  const DynList<double> probs = { 0.1, 0.5, 0.9 };
+  PercentileGrid grid(nt*np*nprops, probs);
+
+  mc.run(mc_samples_arg.getValue(), grid,
+	 [&] (size_t w, const double * x, double * out)
+    {
+      PropertyDag & dag = dags[w];
+      for (size_t i = 0; i < input_units.size(); ++i)
+	dag.set_constant(mc.inputs()(i).name,
+			 VtlQuantity(*input_units(i), x[i]));
+      for (size_t i = 0; i < nt; ++i)
+	{
+	  auto tframe = dag.eval_temperature(ts(i));
+	  auto frames = dag.eval_pressures(tframe, ps);
+	  for (size_t k = 0; k < np; ++k)
+	    {
+	      double * cell = out + (i*np + k)*nprops;
+	      for (size_t j = 0; j < nprops; ++j)
+		{
+		  const VtlQuantity & q = frames(k).vals(prop_idx(j));
+		  cell[j] = q.is_null() ? Unit::Invalid_Value : q.raw();
+		}
+	    }
+	}
+    });
+
+  const string fmt = "%." + ::to_string(dft_precision.getValue()) + "f";
+  auto print = [&fmt, fcts] (size_t col, double val)
+    {
+      printf(fmt.c_str(), fcts[col] ? fcts[col](val) : val);
+    };
+
+  printf("t %s,p %s", final_units[0]->name.c_str(),
+	 final_units[1]->name.c_str());
+  for (size_t j = 0; j < nprops; ++j)
+    for (auto it = probs.get_it(); it.has_curr(); it.next())
+      printf(",%s_p%d %s", (&header.base())[j + 2].first.c_str(),
+	     int(round(100*it.get_curr())), final_units[j + 2]->name.c_str());
+  printf("\n");
+
+  for (size_t i = 0; i < nt; ++i)
+    for (size_t k = 0; k < np; ++k)
       {
-	Blackoil_Pressure_Calculations();
-	row_fct_pb(row, row_units, false);
-	row.popn(n);
+	print(0, ts(i).raw());
+	printf(",");
+	print(1, ps(k).raw());
+	for (size_t j = 0; j < nprops; ++j)
+	  {
+	    const size_t cell = (i*np + k)*nprops + j;
+	    for (size_t l = 0; l < grid.num_percentiles(); ++l)
+	      {
+		printf(",");
+		if (grid.count(cell) > 0)
+		  print(j + 2, grid.value(cell, l));
+	      }
+	  }
+	printf("\n");
       }
-      Blackoil_Pop_Temperature_Parameters();
-    }
 }
 
 # define Simple_Init()						\
@@ -2177,30 +2524,14 @@ void generate_grid_simple()
 	  row_fct_pb(row, row_units, pb_row);
 	  row.popn(n);
 	}
+      end_isotherm();
       Simple_Pop_Temperature_Parameters();
     }
 }
 
 void generate_rows_simple()
 {
-  assert(not tp_values.is_empty());
- 
-  Blackoil_Init();
-  for (auto it = tp_values.get_it(); it.has_curr(); it.next())
-    {
-      auto & curr = it.get_curr();
-      Correlation::NamedPar t_par = curr.first;
-      Correlation::NamedPar p_par = curr.second;
-      Blackoil_Temperature_Calculations();
-
-      VtlQuantity p_q = par(p_par);
-      {
-	Blackoil_Pressure_Calculations();
-	row_fct_pb(row, row_units, false);
-	row.popn(n);
-      }
-      Blackoil_Pop_Temperature_Parameters();
-    }
+  generate_rows_blackoil();
 }
 
 // This routine is invoked to validate the use of one or two separators
@@ -2392,6 +2723,7 @@ void generate_grid_wetgas()
 	  Correlation::NamedPar p_par = p_it.get_curr();
 	  Wetgas_Pressure_Calculations();
 	}
+      end_isotherm();
       Wetgas_Pop_Temperature_Parameters();
     }
 }
@@ -2563,6 +2895,7 @@ void generate_grid_drygas()
 	  Correlation::NamedPar p_par = p_it.get_curr();
 	  Drygas_Pressure_Calculations();
 	}
+      end_isotherm();
 
       Drygas_Pop_Temperature_Parameters();
     }
@@ -2630,6 +2963,26 @@ void generate_grid(const string & fluid_type)
   set_ranges();
 
   transposed = transpose_par.getValue();
+  derivatives = derivatives_par.getValue();
+  if (derivatives and (transposed or filter_par.isSet() or report_exceptions))
+    error_msg("--derivatives cannot be used with --transpose, --filter or"
+	      " --exceptions");
+  if (derivatives and not tp_values.is_empty())
+    error_msg("--derivatives requires --t and --p ranges or arrays");
+
+  if (mc_samples_arg.getValue() > 0)
+    {
+      if (fluid_type != "blackoil")
+	error_msg("--mc-samples is only available for blackoil");
+      if (derivatives or transposed or filter_par.isSet() or report_exceptions)
+	error_msg("--mc-samples cannot be used with --derivatives, --transpose,"
+		  " --filter or --exceptions");
+      if (not tp_values.is_empty())
+	error_msg("--mc-samples requires --t and --p ranges or arrays");
+      generate_monte_carlo_blackoil();
+      exit(0);
+    }
+
   grid_dispatcher.run(fluid_type);
 
   if (transposed)
@@ -2649,6 +3002,7 @@ using OptionPtr = DynList<DynList<double>> (*)();
 int main(int argc, char *argv[])
 {
   cmd.parse(argc, argv);
+  cache_args.enable();
 
   try
     {
@@ -0,0 +1,91 @@
+/** Checks that the memoization cache returns exactly what the
+    correlations compute
+
+    Every correlation is evaluated on random points inside its ranges
+    twice with the cache enabled; the second round must be served from
+    the cache and give the same values than the evaluation without
+    cache.
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <random>
+# include <iostream>
+
+# include <tclap/CmdLine.h>
+
+# include <correlations/pvt-correlations.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-cache", ' ', "0" };
+
+ValueArg<size_t> n = { "n", "n", "points per correlation", false, 100,
+		       "points per correlation", cmd };
+
+ValueArg<unsigned long> seed = { "s", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  mt19937_64 rng(seed.getValue());
+  uniform_real_distribution<double> unif(0, 1);
+
+  // rows and the values computed without cache (NAN if failed)
+  DynList<pair<const Correlation*, DynList<double>>> rows;
+  DynList<double> expected;
+  for (auto it = Correlation::array().get_it(); it.has_curr(); it.next())
+    for (size_t i = 0; i < n.getValue(); ++i)
+      {
+	const Correlation * corr_ptr = it.get_curr();
+	DynList<double> row = corr_ptr->get_preconditions().
+	  maps<double>([&] (const auto & par)
+            {
+	      const double u = unif(rng);
+	      return (1 - u)*par.min_val.raw() + u*par.max_val.raw();
+	    });
+	double val = NAN;
+	try { val = corr_ptr->compute(row, false); } catch (exception &) {}
+	rows.append(make_pair(corr_ptr, row));
+	expected.append(val);
+      }
+
+  CorrelationCache::enable(1 << 20);
+
+  size_t errors = 0;
+  for (size_t round = 0; round < 2; ++round)
+    for (auto it = zip_it(rows, expected); it.has_curr(); it.next())
+      {
+	auto t = it.get_curr();
+	const Correlation * corr_ptr = get<0>(t).first;
+	const double val = get<1>(t);
+	double r = NAN;
+	try { r = corr_ptr->compute(get<0>(t).second, false); }
+	catch (exception &) {}
+	if (not (r == val or (std::isnan(r) and std::isnan(val))))
+	  {
+	    cout << corr_ptr->name << ": " << r << " != " << val << endl;
+	    ++errors;
+	  }
+      }
+
+  const CorrelationCache::Stats stats = CorrelationCache::stats();
+  cout << CorrelationCache::stats_to_string() << endl;
+
+  if (stats.hits == 0)
+    {
+      cout << "Second round was not served from the cache" << endl;
+      ++errors;
+    }
+
+  if (errors)
+    {
+      cout << errors << " errors" << endl;
+      return 1;
+    }
+
+  cout << "Cache test passed" << endl;
+  return 0;
+}
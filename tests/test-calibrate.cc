@@ -410,8 +410,8 @@ eval_correlations(const DynList<PvtAnalyzer::Desc> & lb, // below pb
   const auto & n_above = above_set.samples.size();
   for (size_t i = 1; i < n_above; ++i) // omite 1ra fila
     {
-      pressure.append(above_set.samples(i)(0));
-      lab.append(above_set.samples(i)(col_idx));
+      pressure.append(above_set.samples(i, 0));
+      lab.append(above_set.samples(i, col_idx));
     }
 
   DynList<DynList<double>> ret;
@@ -1021,7 +1021,7 @@ void process_bo(PvtAnalyzer & pvt)
       const double bobp = data.tuned_compute(0, row, below_corr_ptr,
 					     PvtAnalyzer::c(below_desc),
 					     PvtAnalyzer::m(below_desc));
-      data.var_sets(1).samples(0)(2) = bobp;
+      data.var_sets(1).samples(0, 2) = bobp;
     }
 
   auto above_stats = pvt.correlations_stats(above_corr_list, 1);
@@ -1190,7 +1190,7 @@ void process_uo(PvtAnalyzer & pvt)
       const double uobp = data.tuned_compute(0, row, below_corr_ptr,
 					     PvtAnalyzer::c(below_desc),
 					     PvtAnalyzer::m(below_desc));
-      data.var_sets(1).samples(0)(3) = uobp;
+      data.var_sets(1).samples(0, 3) = uobp;
     }
 
   auto dmat = eval_correlations(pvt.correlations_stats(below_corr_list, 0),
@@ -0,0 +1,222 @@
+/** Checks the roots and the statuses of CorrelationInverse
+
+    PbAlMarhoun is monotone in rsb, so the bubble point pressure
+    computed at random points is inverted respect to rsb and the root
+    must be the rsb of the point within the tolerance. The same targets
+    are then solved by solve_batch() on several threads, with a row of
+    parameters per target and with the same row for every target; the
+    results must be the ones of solve().
+
+    The statuses are checked with HoleCorrelation, y = x^3 + x on
+    [0, 10], whose evaluation fails in (4.9, 5.1): a target out of the
+    range of y has no bracket, a bracket whose intervals have the hole
+    as end has none either, and the Brent steps towards a root in the
+    hole are invalid.
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <cmath>
+# include <random>
+# include <iomanip>
+# include <iostream>
+
+# include <tclap/CmdLine.h>
+
+# include <correlations/pvt-correlations.H>
+# include <correlations/correlation-inverse.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-corr-inverse", ' ', "0" };
+
+ValueArg<size_t> n = { "n", "n", "number of random points", false, 1000,
+		       "number of random points", cmd };
+
+ValueArg<unsigned long> seed = { "s", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+ValueArg<double> tol = { "t", "tolerance",
+			 "tolerance relative to the bracket width", false,
+			 1e-10, "tolerance", cmd };
+
+// Registered in the table of correlations, so it lives as the program
+class HoleCorrelation : public Correlation
+{
+  HoleCorrelation()
+    : Correlation("Test", "TestHole", "TestHole", "y", psia::get_instance())
+  {
+    add_parameter("x", psia::get_instance(), "unknown", 0, 10);
+  }
+
+public:
+
+  static const HoleCorrelation & get_instance()
+  {
+    static HoleCorrelation instance;
+    return instance;
+  }
+
+  virtual VtlQuantity compute(const DynList<VtlQuantity> & pars,
+			      bool = true) const
+  {
+    const double x = pars.get_first().raw();
+    if (x > 4.9 and x < 5.1)
+      ZENTHROW(OutOfParameterRange, "x is in the hole");
+    return VtlQuantity(unit, x*x*x + x);
+  }
+};
+
+using Status = CorrelationInverse::Status;
+
+size_t expect(const string & what, const CorrelationInverse::Result & r,
+	      Status status, size_t iterations, size_t evaluations)
+{
+  if (r.status == status and r.iterations == iterations and
+      r.evaluations == evaluations)
+    return 0;
+  cout << what << ": " << CorrelationInverse::status_name(r.status)
+       << " after " << r.iterations << " iterations and " << r.evaluations
+       << " evaluations (expected "
+       << CorrelationInverse::status_name(status) << ", " << iterations
+       << " and " << evaluations << ")" << endl;
+  return 1;
+}
+
+size_t check_statuses()
+{
+  CorrelationInverse inv(&HoleCorrelation::get_instance(), "x");
+  inv.set_tolerance(tol.getValue());
+  const double x = 0;
+  size_t errors = 0;
+
+  // the root of 130 is 5, so the Brent steps end in the hole; every
+  // iteration evaluates once
+  auto r = inv.solve(&x, 130);
+  if (r.status != Status::Invalid or r.iterations == 0 or
+      r.evaluations != r.iterations + 2)
+    errors += expect("Brent step into the hole", r, Status::Invalid,
+		     r.iterations, r.iterations + 2);
+
+  // y(10) = 1010
+  errors += expect("target out of the range", inv.solve(&x, 2000),
+		   Status::NoBracket, 0, 2);
+
+  // the intervals [0, 5] and [5, 10] have the hole as end
+  inv.set_num_intervals(2);
+  errors += expect("intervals ending in the hole", inv.solve(&x, 10),
+		   Status::NoBracket, 0, 3);
+
+  // [0, 2.5] changes of sign and its Brent steps do not reach the
+  // hole; the last iteration does not evaluate
+  inv.set_num_intervals(4);
+  r = inv.solve(&x, 10);
+  if (not r.converged() or fabs(r.value - 2) > 4*tol.getValue()*10 or
+      r.evaluations != r.iterations + 1)
+    {
+      cout << "root of 10 = " << setprecision(17) << r.value << " ("
+	   << CorrelationInverse::status_name(r.status) << " after "
+	   << r.iterations << " iterations and " << r.evaluations
+	   << " evaluations)" << endl;
+      ++errors;
+    }
+
+  // y(0) = 0 is exactly the target
+  inv.set_num_intervals(1);
+  errors += expect("target at the bracket end", inv.solve(&x, 0),
+		   Status::Converged, 0, 2);
+
+  return errors;
+}
+
+bool same(const CorrelationInverse::Result & r1,
+	  const CorrelationInverse::Result & r2)
+{
+  return r1.value == r2.value and r1.status == r2.status and
+    r1.iterations == r2.iterations and r1.evaluations == r2.evaluations;
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  size_t errors = check_statuses();
+
+  const Correlation * corr_ptr = Correlation::search_by_name("PbAlMarhoun");
+  CorrelationInverse inv(corr_ptr, "rsb");
+  inv.set_tolerance(tol.getValue());
+  const size_t np = inv.num_pars(), var = inv.parameter();
+  const double width = inv.bracket_max() - inv.bracket_min();
+
+  mt19937_64 rng(seed.getValue());
+  uniform_real_distribution<double> unif(0, 1);
+  vector<double> args, targets;
+  for (size_t i = 0; i < n.getValue(); ++i)
+    {
+      vector<double> row;
+      for (auto it = corr_ptr->get_preconditions().get_it(); it.has_curr();
+	   it.next())
+	{
+	  const double min = it.get_curr().min_val.raw();
+	  const double max = it.get_curr().max_val.raw();
+	  row.push_back(min + unif(rng)*(max - min));
+	}
+      double pb;
+      if (corr_ptr->compute_batch(row.data(), 1, &pb, false, false) > 0)
+	continue;
+
+      const auto r = inv.solve(row.data(), pb);
+      if (not r.converged() or
+	  fabs(r.value - row[var]) > 4*tol.getValue()*width)
+	{
+	  cout << setprecision(17) << "rsb of pb = " << pb << " is "
+	       << r.value << " instead of " << row[var] << " ("
+	       << CorrelationInverse::status_name(r.status) << ")" << endl;
+	  ++errors;
+	}
+      args.insert(args.end(), row.begin(), row.end());
+      targets.push_back(pb);
+    }
+
+  // a row per target and the first row for every target
+  const size_t num_targets = targets.size();
+  for (size_t step : { np, size_t(0) })
+    {
+      vector<CorrelationInverse::Result> seq(num_targets);
+      size_t seq_failed = 0;
+      for (size_t k = 0; k < num_targets; ++k)
+	{
+	  seq[k] = inv.solve(args.data() + k*step, targets[k]);
+	  seq_failed += not seq[k].converged();
+	}
+
+      for (size_t nt : { 1, 2, 3, 8 })
+	{
+	  inv.set_num_threads(nt);
+	  vector<CorrelationInverse::Result> out(num_targets);
+	  const size_t failed = inv.solve_batch(args.data(), step,
+						targets.data(), num_targets,
+						out.data());
+	  size_t diffs = 0;
+	  for (size_t k = 0; k < num_targets; ++k)
+	    diffs += not same(out[k], seq[k]);
+	  if (diffs > 0 or failed != seq_failed)
+	    {
+	      cout << "solve_batch() with step " << step << " on " << nt
+		   << " threads: " << diffs << " results differ from solve(), "
+		   << failed << " failed instead of " << seq_failed << endl;
+	      ++errors;
+	    }
+	}
+    }
+
+  cout << num_targets << " targets inverted" << endl;
+  if (errors)
+    {
+      cout << errors << " errors" << endl;
+      return 1;
+    }
+
+  cout << "Correlation inverse test passed" << endl;
+  return 0;
+}
@@ -0,0 +1,150 @@
+/** Compares the statistics of CorrStat with the ones of gsl
+
+    CorrStat accumulates its statistics in one pass with interleaved
+    Welford updates (see CorrStat::Moments). This test evaluates r2(),
+    mse(), sigma_distance(), linear_fit() and stats() on random data
+    sets y = a + b yc + noise and compares them with
+    gsl_stats_correlation(), gsl_fit_linear() and the direct two pass
+    formulas. The data sets have sizes that are not multiple of the
+    number of lanes, values far from zero and near perfect fits, which
+    are the cases where a naive accumulation loses its precision.
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <cmath>
+# include <limits>
+# include <random>
+# include <iostream>
+
+# include <gsl/gsl_fit.h>
+# include <gsl/gsl_statistics_double.h>
+
+# include <tclap/CmdLine.h>
+
+# include <correlations/correlation-stats.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-corr-stats", ' ', "0" };
+
+ValueArg<size_t> n = { "n", "n", "data sets per case", false, 20,
+		       "data sets per case", cmd };
+
+ValueArg<unsigned long> seed = { "s", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+ValueArg<double> tol = { "t", "tolerance", "maximum relative error", false,
+			 1e-8, "tolerance", cmd };
+
+size_t errors = 0;
+
+// v and ref must differ less than t times the largest of |v|, |ref|
+// and scale
+void check(const string & what, double v, double ref, double t,
+	   double scale = 0)
+{
+  scale = max(scale, max(fabs(ref), fabs(v)));
+  if (fabs(v - ref) <= t*scale or (std::isnan(v) and std::isnan(ref)))
+    return;
+  cout << what << ": " << v << " != " << ref << " (gsl)" << endl;
+  ++errors;
+}
+
+void test(const Array<double> & y, const Array<double> & yc,
+	  const string & label)
+{
+  const size_t num = y.size();
+  const double * py = &y.base();
+  const double * px = &yc.base();
+
+  double c, m, cov00, cov01, cov11, sumsq;
+  gsl_fit_linear(px, 1, py, 1, num, &c, &m, &cov00, &cov01, &cov11, &sumsq);
+  const double r = gsl_stats_correlation(px, 1, py, 1, num);
+
+  double sdd = 0, esum = 0;
+  for (size_t i = 0; i < num; ++i)
+    {
+      sdd += (py[i] - px[i])*(py[i] - px[i]);
+      esum += fabs(py[i] - px[i]);
+    }
+  const double em = esum/num;
+  double see = 0;
+  for (size_t i = 0; i < num; ++i)
+    see += (fabs(py[i] - px[i]) - em)*(fabs(py[i] - px[i]) - em);
+
+  // The residuals lose about eps |y|/rms(residual) of relative precision
+  // in both implementations, so sumsq and the covariances are compared
+  // with a tolerance that grows with this ratio. c is the difference
+  // of ym and m xm, so its error is relative to m xm
+  double ymax = 0;
+  for (size_t i = 0; i < num; ++i)
+    ymax = max(ymax, fabs(py[i]));
+  const double t = tol.getValue();
+  const double tr =
+    max(t, 16*numeric_limits<double>::epsilon()*ymax/sqrt(sumsq/num));
+
+  CorrStat stat(y);
+  check(label + " r2", stat.r2(yc), r*r, t);
+  check(label + " mse", stat.mse(yc), sqrt(sdd/num), t);
+  check(label + " sigma_distance", stat.sigma_distance(yc), sqrt(see/num), t);
+
+  const CorrStat::LFit fit = stat.linear_fit(yc);
+  check(label + " c", fit.c, c, t, fabs(m*gsl_stats_mean(px, 1, num)));
+  check(label + " m", fit.m, m, t);
+  check(label + " cov00", fit.cov00, cov00, tr);
+  check(label + " cov01", fit.cov01, cov01, tr);
+  check(label + " cov11", fit.cov11, cov11, tr);
+  check(label + " sumsq", fit.sumsq, sumsq, tr);
+
+  // stats() must give exactly the same values than the separate calls
+  const CorrStat::Desc d = stat.stats(yc);
+  if (CorrStat::r2(d) != stat.r2(yc) or CorrStat::mse(d) != stat.mse(yc) or
+      CorrStat::sigma(d) != stat.sigma_distance(yc) or not (get<3>(d) == fit))
+    {
+      cout << label << ": stats() differs from r2(), mse(), "
+	   << "sigma_distance() or linear_fit()" << endl;
+      ++errors;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  mt19937_64 rng(seed.getValue());
+  uniform_real_distribution<double> unif(0, 1);
+  normal_distribution<double> normal(0, 1);
+
+  const size_t sizes[] = { 3, 4, 7, 64, 1001 };
+  const double offsets[] = { 0, 1e3, 1e5 };
+  const double noises[] = { 1, 1e-3, 1e-6 };
+
+  size_t cases = 0;
+  for (auto num : sizes)
+    for (auto offset : offsets)
+      for (auto noise : noises)
+	for (size_t k = 0; k < n.getValue(); ++k, ++cases)
+	  {
+	    const double a = 10*(unif(rng) - 0.5), b = 0.5 + unif(rng);
+	    Array<double> y, yc;
+	    for (size_t i = 0; i < num; ++i)
+	      {
+		const double x = offset + 100*unif(rng);
+		yc.append(x);
+		y.append(a + b*x + noise*normal(rng));
+	      }
+	    test(y, yc, "size " + to_string(num) + " offset " +
+		 to_string(offset) + " noise " + to_string(noise));
+	  }
+
+  if (errors)
+    {
+      cout << errors << " statistics out of tolerance " << tol.getValue()
+	   << " in " << cases << " data sets" << endl;
+      return 1;
+    }
+
+  cout << "Correlation statistics test passed" << endl;
+  return 0;
+}
@@ -20,6 +20,8 @@
 # include <correlations/correlation.H>
 
 # include <correlations/pvt-correlations.H>
+# include <correlations/correlation-sweep.H>
+# include <correlations/correlation-inverse.H>
 
 using namespace TCLAP;
 
@@ -248,33 +250,60 @@ void mat_csv(const Correlation * const corr_ptr, size_t n)
     });
 }
 
+// Evaluate the cartesian product of the ranges l with a
+// CorrelationSweep on num_threads threads and write it in csv or, if
+// binary, as rows of native doubles (see CorrelationSweep). Unless
+// ignore_exception is set, the output stops at the first failed point
+// and the exception of that point is thrown
 void mat_csv(const Correlation * const corr_ptr, const DynList<RangeDesc> & l,
-	     bool ignore_exception)
-{      // csv header
-  corr_ptr->get_preconditions().for_each([] (auto pre)
-    {
-      cout << pre.name << " (" << pre.unit.symbol << "), ";
-    });
-  cout << corr_ptr->name << " (" << corr_ptr->unit.name << ")" << endl;
+	     bool ignore_exception, size_t num_threads, bool binary)
+{
+  CorrelationSweep sweep(corr_ptr);
+  l.for_each([&sweep] (const auto & r)
+	     { sweep.set_axis(r.i, r.min, r.max, r.n); });
+  sweep.set_check(check);
+  sweep.set_num_threads(num_threads);
+
+  const size_t np = sweep.num_pars();
+  const size_t row_size = (np + 1)*sizeof(double);
 
-  auto pars = generate_pars_values(l);
-  traverse_perm(pars, [corr_ptr, ignore_exception] (const auto & s)
+  if (not binary)
+    cout << sweep.csv_header() << endl;
+  cout.flush();
+
+  sweep.run([np, binary] (auto & b)
     {
-      try
+      if (binary)
+	CorrelationSweep::format_binary(b, np);
+      else
+	CorrelationSweep::format_csv(b, np);
+    },
+    [&] (const auto & b)
+    {
+      if (ignore_exception or b.failures == 0)
 	{
-	  s.for_each([] (auto v) { cout << v << ", "; });
-	  auto r = corr_ptr->compute_and_check(s, check);
-	  cout << r << endl;
+	  fwrite(b.out.data(), 1, b.out.size(), stdout);
+	  return true;
 	}
-      catch (...)
-	{
-	  if (ignore_exception)
-	    cout << endl;
-	  else
-	    throw;
-	}
-      return true;
+
+      // write the rows before the failed point and throw its exception
+      size_t k = 0;
+      while (b.results[k] != Unit::Invalid_Value)
+	++k;
+      size_t len = k*row_size;
+      if (not binary)
+	for (size_t i = len = 0; i < k; ++i)
+	  len = b.out.find('\n', len) + 1;
+      fwrite(b.out.data(), 1, len, stdout);
+      fflush(stdout);
+
+      DynList<double> pars;
+      for (size_t i = 0; i < np; ++i)
+	pars.append(b.args[k*np + i]);
+      corr_ptr->compute_and_check(pars, check);
+      ZENTHROW(InvalidValue, "point " + ::to_string(b.first + k) + " failed");
     });
+  fflush(stdout);
 }
 
 using P = pair<double, DynList<double>>;
@@ -405,6 +434,13 @@ void test(int argc, char *argv[])
 
   SwitchArg csv = { "c", "csv", "generate csv", cmd };
 
+  SwitchArg binary = { "b", "binary",
+		       "with -c, write rows of native doubles instead of csv",
+		       cmd };
+
+  ValueArg<size_t> threads = { "t", "threads", "threads for evaluating -c",
+			       false, 1, "number of threads", cmd };
+
   SwitchArg json = { "j", "json", "output in json", cmd };
 
   ValueArg<string> json_corr = { "J", "json-corr", "json for correlation",
@@ -442,6 +478,15 @@ void test(int argc, char *argv[])
 
   SwitchArg ruby = { "R", "ruby-hash", "generate ruby hash", cmd };
 
+  ValueArg<string> invert = { "I", "invert",
+			      "solve for this parameter the value for which "
+			      "the correlation gives --target (its passed "
+			      "value is ignored)", false, "", "parameter name",
+			      cmd };
+
+  ValueArg<double> target = { "", "target", "target result of --invert",
+			      false, 0, "target value", cmd };
+
   cmd.parse(argc, argv);
 
   if (ruby.getValue())
@@ -643,7 +688,8 @@ void test(int argc, char *argv[])
       if (csv.getValue())
 	{
 	  //mat_csv(correlation_ptr, n.getValue());
-	  mat_csv(correlation_ptr, ranges.keys(), ignore.getValue());
+	  mat_csv(correlation_ptr, ranges.keys(), ignore.getValue(),
+		  threads.getValue(), binary.getValue());
 	  return;
 	}
 
@@ -694,6 +740,25 @@ void test(int argc, char *argv[])
       params(p.i - 1) = unit_ptr;
     }
 
+  if (invert.isSet())
+    {
+      CorrelationInverse inv(correlation_ptr, invert.getValue());
+      inv.set_check(check);
+      if (pars.getValue().size() != inv.num_pars())
+	{
+	  cout << "Error: " << inv.num_pars() << " parameter values expected"
+	       << endl;
+	  abort();
+	}
+      const auto r = inv.solve(pars.getValue().data(), target.getValue());
+      if (r.converged())
+	cout << invert.getValue() << " = " << r.value << " ";
+      cout << "(" << CorrelationInverse::status_name(r.status) << ", "
+	   << r.iterations << " iterations, " << r.evaluations
+	   << " evaluations)" << endl;
+      return;
+    }
+
   auto pars_list = zip(params, to_DynList(pars.getValue())).
     maps<VtlQuantity>([] (auto p) { return VtlQuantity(*p.first, p.second); });
 
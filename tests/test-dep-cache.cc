@@ -0,0 +1,231 @@
+/** Checks the invalidation rules of PvtDepCache
+
+    A value is cached for every target; then the correlation, the c or
+    the m of each target is changed in turn and only that target and
+    the ones that depend on it, according to the graph documented in
+    PvtDepCache, must be recomputed. The graph is written here again so
+    that a change in PvtDepCache::depends_on() is noticed. The same is
+    checked for invalidate(target), and invalidate() must discard
+    everything.
+
+    Then the values cached through PvtData::dep_value() must be
+    recomputed after setting uod_corr only for uod, and for every
+    target after a constant or a vector is added or removed and after
+    invalidate_dep_cache().
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <iostream>
+
+# include <tclap/CmdLine.h>
+
+# include <metadata/pvt-tuner.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-dep-cache", ' ', "0" };
+
+using Cache = PvtDepCache;
+using Settings = Cache::Setting[Cache::Num_Targets];
+
+const char * target_names[Cache::Num_Targets] =
+  { "pb", "uod", "rs", "bob", "coa", "boa", "uob", "uoa" };
+
+// tgt and the targets that use it, directly or not
+unsigned affected(size_t tgt)
+{
+  static const pair<size_t, size_t> edges[] =
+    {
+      { Cache::Pb, Cache::Uod }, { Cache::Pb, Cache::Rs },
+      { Cache::Pb, Cache::Bob }, { Cache::Pb, Cache::Coa },
+      { Cache::Pb, Cache::Boa }, { Cache::Pb, Cache::Uob },
+      { Cache::Pb, Cache::Uoa }, { Cache::Uod, Cache::Uob },
+      { Cache::Uod, Cache::Uoa }, { Cache::Rs, Cache::Bob },
+      { Cache::Rs, Cache::Uob }, { Cache::Bob, Cache::Boa },
+      { Cache::Bob, Cache::Uob }, { Cache::Coa, Cache::Boa },
+      { Cache::Uob, Cache::Uoa }
+    };
+  unsigned ret = 1u << tgt;
+  for (const auto & e : edges)
+    if (e.first == tgt)
+      ret |= affected(e.second);
+  return ret;
+}
+
+string names_of(unsigned targets)
+{
+  string ret;
+  for (size_t i = 0; i < Cache::Num_Targets; ++i)
+    if (targets & (1u << i))
+      ret += string(ret.empty() ? "" : " ") + target_names[i];
+  return "{" + ret + "}";
+}
+
+Cache::Key key()
+{
+  return PvtData::dep_key(&psia::get_instance(), { 1, 2 });
+}
+
+// Cache a value per target under settings
+void fill(Cache & cache, const Settings & settings)
+{
+  for (size_t i = 0; i < Cache::Num_Targets; ++i)
+    {
+      ValPair val;
+      if (not cache.search(settings, Cache::Target(i), key(), val))
+	cache.insert(Cache::Target(i), key(),
+		     ValPair(i, &psia::get_instance()));
+    }
+}
+
+// Targets whose value is not found under settings
+unsigned missing(Cache & cache, const Settings & settings)
+{
+  unsigned ret = 0;
+  for (size_t i = 0; i < Cache::Num_Targets; ++i)
+    {
+      ValPair val;
+      if (not cache.search(settings, Cache::Target(i), key(), val) or
+	  val.first != i)
+	ret |= 1u << i;
+    }
+  return ret;
+}
+
+size_t expect(const string & what, unsigned found, unsigned expected)
+{
+  if (found == expected)
+    return 0;
+  cout << what << ": " << names_of(found) << " instead of "
+       << names_of(expected) << endl;
+  return 1;
+}
+
+size_t check_cache()
+{
+  const auto & corrs = Correlation::array();
+  Settings base;
+  for (size_t i = 0; i < Cache::Num_Targets; ++i)
+    base[i] = Cache::Setting(corrs(i), 0, 1);
+
+  size_t errors = 0;
+  for (size_t tgt = 0; tgt < Cache::Num_Targets; ++tgt)
+    {
+      const string name = target_names[tgt];
+      for (size_t change = 0; change < 3; ++change)
+	{
+	  Cache cache;
+	  fill(cache, base);
+	  errors += expect("cached " + name, missing(cache, base), 0);
+
+	  Settings settings;
+	  copy(begin(base), end(base), begin(settings));
+	  Cache::Setting & s = settings[tgt];
+	  if (change == 0)
+	    s.corr_ptr = corrs(Cache::Num_Targets);
+	  else if (change == 1)
+	    s.c = 0.5;
+	  else
+	    s.m = 2;
+	  const string what = string(change == 0 ? "corr" : change == 1 ?
+				     "c" : "m") + " of " + name + " changed";
+
+	  cache.update(settings);
+	  unsigned dirty = 0;
+	  for (size_t i = 0; i < Cache::Num_Targets; ++i)
+	    dirty |= cache.is_dirty(Cache::Target(i)) ? 1u << i : 0;
+	  errors += expect(what + ", dirty", dirty, affected(tgt));
+	  errors += expect(what + ", recomputed", missing(cache, settings),
+			   affected(tgt));
+	}
+
+      Cache cache;
+      fill(cache, base);
+      cache.invalidate(Cache::Target(tgt));
+      errors += expect(name + " invalidated", missing(cache, base),
+		       affected(tgt));
+    }
+
+  Cache cache;
+  fill(cache, base);
+  cache.invalidate();
+  errors += expect("all invalidated", missing(cache, base),
+		   (1u << Cache::Num_Targets) - 1);
+
+  return errors;
+}
+
+size_t check_pvt_data()
+{
+  PvtData data;
+  unsigned computed = 0; // targets computed since the last check
+
+  auto value = [&] (Cache::Target tgt)
+    {
+      return data.dep_value(tgt, key(), [&computed, tgt]
+        {
+	  computed |= 1u << tgt;
+	  return VtlQuantity(psia::get_instance(), 1000 + tgt);
+	}).raw();
+    };
+  const unsigned all = (1u << Cache::Num_Targets) - 1;
+
+  // compute every target and return the recomputed ones
+  auto recomputed = [&] ()
+    {
+      computed = 0;
+      size_t errors = 0;
+      for (size_t i = 0; i < Cache::Num_Targets; ++i)
+	errors += value(Cache::Target(i)) != 1000 + i;
+      if (errors)
+	cout << errors << " wrong cached values" << endl;
+      return errors ? all + 1 : computed;
+    };
+
+  size_t errors = expect("first evaluation", recomputed(), all);
+  errors += expect("second evaluation", recomputed(), 0);
+
+  data.uod_corr = Correlation::search_by_name("UodBeal");
+  errors += expect("uod_corr set", recomputed(),
+		   1u << Cache::Uod | 1u << Cache::Uob | 1u << Cache::Uoa);
+
+  data.add_const("api", 30, Api::get_instance());
+  errors += expect("add_const()", recomputed(), all);
+
+  data.rm_const("api");
+  errors += expect("rm_const()", recomputed(), all);
+
+  Array<double> p, rs;
+  for (double v : { 500, 1000, 2000 })
+    {
+      p.append(v);
+      rs.append(v/5);
+    }
+  data.add_vector(200, 2000, 1.2, 2, 1, p, psia::get_instance(), "rs", rs,
+		  SCF_STB::get_instance());
+  errors += expect("add_vector()", recomputed(), all);
+
+  data.rm_vector(200, "rs");
+  errors += expect("rm_vector()", recomputed(), all);
+
+  data.invalidate_dep_cache();
+  errors += expect("invalidate_dep_cache()", recomputed(), all);
+
+  return errors;
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  const size_t errors = check_cache() + check_pvt_data();
+  if (errors)
+    {
+      cout << errors << " errors" << endl;
+      return 1;
+    }
+
+  cout << "Dependency cache test passed" << endl;
+  return 0;
+}
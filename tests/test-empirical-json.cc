@@ -25,10 +25,7 @@ int main(int argc, char *argv[])
       return 0;
     }
 
-  stringstream s;
-  s << input.rdbuf();
-  
-  EmpiricalData e(s.str());
+  EmpiricalData e(input);
 
   cout << e.full_desc() << endl;
   
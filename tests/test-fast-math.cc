@@ -0,0 +1,212 @@
+/** Compares the correlations computed with and without PVT_FAST_MATH
+
+    Every correlation is evaluated with Correlation::compute_batch() on
+    n points of the declared ranges of its parameters: the first point
+    has the minimum of every range, the second one the maximum and the
+    rest are random. The points only depend on the seed, so that the
+    same points are evaluated in both builds (see pvt-fast-math.H):
+
+        test-fast-math -o exact.txt    # built without PVT_FAST_MATH
+        test-fast-math -r exact.txt    # built with PVT_FAST_MATH
+
+    The second run reports, per correlation, the maximum and mean
+    relative errors respect to the saved values and the number of
+    points that failed in only one of the builds. It fails if any
+    error is greater than the tolerance or any point fails in only one
+    build.
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <cmath>
+# include <random>
+# include <fstream>
+# include <iomanip>
+# include <iostream>
+
+# include <tclap/CmdLine.h>
+
+# include <tpl_dynMapTree.H>
+# include <correlations/pvt-correlations.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-fast-math", ' ', "0" };
+
+ValueArg<size_t> n = { "n", "n", "points per correlation", false, 1000,
+		       "points per correlation", cmd };
+
+ValueArg<unsigned long> seed = { "s", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+ValueArg<string> corr_name = { "c", "correlation", "only this correlation",
+			       false, "", "correlation name", cmd };
+
+ValueArg<double> tol = { "t", "tolerance", "maximum relative error", false,
+			 1e-8, "tolerance", cmd };
+
+ValueArg<string> out_name = { "o", "output", "file where to save the values",
+			      false, "", "output file name" };
+
+ValueArg<string> ref_name = { "r", "reference",
+			      "file of values to compare with", false, "",
+			      "reference file name" };
+
+// Values at the points of corr_ptr; NAN if the point failed. The
+// random points are generated from the seed and the name, so they do
+// not depend on the other correlations
+vector<double> evaluate(const Correlation * corr_ptr)
+{
+  const string key = to_string(seed.getValue()) + corr_ptr->name;
+  seed_seq sseq(key.begin(), key.end());
+  mt19937_64 rng(sseq);
+  uniform_real_distribution<double> unif(0, 1);
+  const size_t np = corr_ptr->get_num_pars(), num = n.getValue();
+  vector<double> args(num*np), ret(num);
+  for (size_t k = 0; k < num; ++k)
+    {
+      size_t i = 0;
+      for (auto it = corr_ptr->get_preconditions().get_it(); it.has_curr();
+	   it.next(), ++i)
+	{
+	  const double min = it.get_curr().min_val.raw();
+	  const double max = it.get_curr().max_val.raw();
+	  const double u = k == 0 ? 0 : k == 1 ? 1 : unif(rng);
+	  args[k*np + i] = (1 - u)*min + u*max;
+	}
+    }
+
+  corr_ptr->compute_batch(args.data(), num, ret.data(), false, false);
+  for (auto & r : ret)
+    if (r == Unit::Invalid_Value or not isfinite(r))
+      r = NAN;
+
+  return ret;
+}
+
+double relative_error(double v, double d)
+{
+  return v != 0 ? fabs(d - v)/fabs(v) : fabs(d);
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.xorAdd(out_name, ref_name);
+  cmd.parse(argc, argv);
+
+  cout << "exp, log and pow: "
+       << (PvtFastMath::compiled() ? "PvtFastMath" : "<cmath>") << endl;
+  if (ref_name.isSet() and not PvtFastMath::compiled())
+    cout << "warning: this program was not compiled with PVT_FAST_MATH"
+	 << endl;
+
+  DynList<const Correlation*> corrs;
+  if (corr_name.isSet())
+    {
+      auto corr_ptr = Correlation::search_by_name(corr_name.getValue());
+      if (corr_ptr == nullptr)
+	{
+	  cout << "correlation " << corr_name.getValue() << " not found"
+	       << endl;
+	  return 1;
+	}
+      corrs.append(corr_ptr);
+    }
+  else
+    for (auto it = Correlation::array().get_it(); it.has_curr(); it.next())
+      corrs.append(it.get_curr());
+
+  if (out_name.isSet())
+    {
+      ofstream out(out_name.getValue());
+      if (not out)
+	{
+	  cout << "cannot open " << out_name.getValue() << endl;
+	  return 1;
+	}
+      out << setprecision(17);
+      for (auto it = corrs.get_it(); it.has_curr(); it.next())
+	{
+	  const vector<double> vals = evaluate(it.get_curr());
+	  out << it.get_curr()->name << " " << vals.size() << endl;
+	  for (auto v : vals)
+	    out << v << endl;
+	}
+      cout << corrs.size() << " correlations saved in "
+	   << out_name.getValue() << endl;
+      return 0;
+    }
+
+  // reference values by name, read as strings so that nan is accepted
+  ifstream in(ref_name.getValue());
+  if (not in)
+    {
+      cout << "cannot open " << ref_name.getValue() << endl;
+      return 1;
+    }
+  DynMapTree<string, vector<double>> refs;
+  string name;
+  size_t num;
+  while (in >> name >> num)
+    {
+      vector<double> vals(num);
+      string s;
+      for (size_t k = 0; k < num and in >> s; ++k)
+	vals[k] = strtod(s.c_str(), nullptr);
+      refs.insert(name, move(vals));
+    }
+
+  size_t errors = 0;
+  double worst = 0;
+  cout << setw(36) << left << "correlation" << right << setw(8) << "points"
+       << setw(14) << "max error" << setw(14) << "mean error"
+       << setw(10) << "mismatch" << endl;
+  for (auto it = corrs.get_it(); it.has_curr(); it.next())
+    {
+      const Correlation * corr_ptr = it.get_curr();
+      const vector<double> vals = evaluate(corr_ptr);
+      auto p = refs.search(corr_ptr->name);
+      if (p == nullptr or p->second.size() != vals.size())
+	{
+	  cout << corr_ptr->name << ": not in " << ref_name.getValue()
+	       << " or with other number of points" << endl;
+	  ++errors;
+	  continue;
+	}
+
+      const vector<double> & ref = p->second;
+      size_t points = 0, mismatches = 0;
+      double max_err = 0, sum = 0;
+      for (size_t k = 0; k < vals.size(); ++k)
+	{
+	  if (std::isnan(ref[k]) or std::isnan(vals[k]))
+	    {
+	      mismatches += std::isnan(ref[k]) != std::isnan(vals[k]);
+	      continue;
+	    }
+	  const double e = relative_error(ref[k], vals[k]);
+	  max_err = max(max_err, e);
+	  sum += e;
+	  ++points;
+	}
+      worst = max(worst, max_err);
+
+      const bool failed = max_err > tol.getValue() or mismatches > 0;
+      errors += failed;
+      cout << setw(36) << left << corr_ptr->name << right << setw(8) << points
+	   << scientific << setprecision(3) << setw(14) << max_err
+	   << setw(14) << (points ? sum/points : 0.0) << setw(10) << mismatches
+	   << (failed ? "  FAIL" : "") << defaultfloat << endl;
+    }
+
+  cout << "largest relative error " << worst << endl;
+  if (errors)
+    {
+      cout << errors << " correlations out of tolerance " << tol.getValue()
+	   << endl;
+      return 1;
+    }
+
+  cout << "Fast math test passed" << endl;
+  return 0;
+}
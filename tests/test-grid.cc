@@ -61,6 +61,27 @@ ValueArg<string> var_name =
 
 SwitchArg print = { "P", "print", "print grid", cmd };
 
+SwitchArg derivatives = { "d", "derivatives", "add d/dp and d/dt columns", cmd };
+
+ValueArg<size_t> lazy =
+  { "l", "lazy", "read the isotherms on demand keeping at most n of them "
+    "in memory (the index is written if it does not exist)", false, 2, "n",
+    cmd };
+
+ValueArg<double> compress =
+  { "c", "compress", "pack the grid with the given maximum relative error",
+    false, 1e-4, "max relative error", cmd };
+
+vector<string> encodings = { "float", "fixed16", "delta8" };
+ValuesConstraint<string> allowed_encodings = encodings;
+ValueArg<string> encoding = { "", "encoding", "encoding of the packed grid",
+			      false, "fixed16", &allowed_encodings, cmd };
+
+vector<string> lookup_modes = { "throw", "nan", "clamp" };
+ValuesConstraint<string> allowed_lookup_modes = lookup_modes;
+ValueArg<string> lookup = { "", "lookup", "handling of empty grid cells",
+			    false, "throw", &allowed_lookup_modes, cmd };
+
 vector<string> output_types = { "R", "csv", "mat" };
 ValuesConstraint<string> allowed_output_types = output_types;
 ValueArg<string> output = { "", "output", "output type", false,
@@ -74,7 +95,11 @@ void process_output(const string & name, const DynList<DynList<double>> & l)
       {
 	return l.template maps<string>([] (auto v) { return to_string(v); });
       });
-      out.insert(build_dynlist<string>("t", "p", name)); // header
+      auto header = build_dynlist<string>("t", "p", name);
+      if (derivatives.getValue())
+	header.append(build_dynlist<string>("d" + name + "_dp",
+					    "d" + name + "_dt"));
+      out.insert(header);
       return out;
     };
   
@@ -165,9 +190,34 @@ int main(int argc, char *argv[])
   const string & file_name = file.getValue();
   if (not exists_file(file_name))
     error_msg("file " + file_name + " does not exist");
-  ifstream in(file_name);
+  PvtGrid grid;
+  if (lazy.isSet())
+    {
+      if (not exists_file(PvtGrid::index_name(file_name)))
+	PvtGrid::write_index(file_name);
+      grid = PvtGrid(file_name, lazy.getValue());
+    }
+  else
+    {
+      ifstream in(file_name);
+      grid = PvtGrid(in);
+    }
 
-  PvtGrid grid(in);
+  if (compress.isSet())
+    {
+      using Encoding = PvtGrid::Encoding;
+      const string & e = encoding.getValue();
+      const Encoding enc = e == "float" ? Encoding::Float :
+	e == "delta8" ? Encoding::Delta8 : Encoding::Fixed16;
+      const size_t bytes = grid.memory_bytes();
+      const double err = grid.compress(compress.getValue(), enc);
+      cerr << "grid packed from " << bytes << " to " << grid.memory_bytes()
+	   << " bytes with a maximum relative error of " << err << endl;
+      for (auto e : { Encoding::Double, Encoding::Float, Encoding::Fixed16,
+	    Encoding::Delta8 })
+	cerr << "  " << PackedColumn::encoding_name(e) << " columns: "
+	     << grid.num_columns(e) << endl;
+    }
 
   if (print.getValue())
     {
@@ -178,16 +228,40 @@ int main(int argc, char *argv[])
   if (not (t.isSet() and p.isSet() and var_name.isSet()))
     return 0;
 
+  if (derivatives.getValue() and output.getValue() == "R")
+    error_msg("--derivatives cannot be used with R output");
+
   DynList<DynList<double>> l;
   const string & name = var_name.getValue();
   const auto & tdesc = t.getValue();
   const auto & pdesc = p.getValue();
+  const size_t name_idx = grid.property_index(name);
+  const PvtGrid::Lookup mode =
+    lookup.getValue() == "nan" ? PvtGrid::Lookup::NaN :
+    lookup.getValue() == "clamp" ? PvtGrid::Lookup::Clamp :
+    PvtGrid::Lookup::Throw;
   for (double tval = tdesc.min; tval <= tdesc.max; tval += tdesc.step())
     for (double pval = pdesc.min; pval <= pdesc.max; pval += pdesc.step())
-      l.append(build_dynlist<double>(tval, pval,
-				     grid(name, Quantity<Fahrenheit>(tval),
-					  Quantity<psia>(pval)).raw()));
+      if (derivatives.getValue())
+	{
+	  auto d = grid.compute_with_derivatives(name,
+						 Quantity<Fahrenheit>(tval),
+						 Quantity<psia>(pval));
+	  l.append(build_dynlist<double>(tval, pval, d.value.raw(),
+					 d.dp, d.dt));
+	}
+      else if (mode == PvtGrid::Lookup::Throw)
+	l.append(build_dynlist<double>(tval, pval,
+				       grid(name, Quantity<Fahrenheit>(tval),
+					    Quantity<psia>(pval)).raw()));
+      else
+	l.append(build_dynlist<double>(tval, pval,
+				       grid.compute(name_idx, tval, pval, mode)));
 
   process_output(name, l);
+
+  if (grid.is_lazy())
+    cerr << grid.slab_loads() << " isotherms read, "
+	 << grid.resident_slabs() << " in memory" << endl;
 }
 
@@ -0,0 +1,145 @@
+/** Checks that the streaming json reader loads the same EmpiricalData
+    as the json document
+
+    Every file given in the command line that has var sets (for
+    example tests/113.json, tests/cerro-negro.json and tests/data.json
+    among tests/*.json) is loaded with EmpiricalData::set_from_json()
+    from the stream, which uses JsonReader, and from the nlohmann
+    document; both must have the same json dump. The file is loaded
+    again from the stream with unknown keys, which must be skipped,
+    added to the data, to a var set and to a variable. The other files
+    are skipped.
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <fstream>
+# include <sstream>
+# include <iostream>
+
+# include <tclap/CmdLine.h>
+
+# include <json.hpp>
+
+# include <metadata/empirical-data.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-json-reader", ' ', "0" };
+
+UnlabeledMultiArg<string> files = { "files", "json files", true,
+				    "json file names", cmd };
+
+string from_stream(const string & text)
+{
+  istringstream in(text);
+  EmpiricalData data;
+  data.set_from_json(in);
+  return data.to_json();
+}
+
+string from_document(const json & j)
+{
+  EmpiricalData data;
+  data.set_from_json(j);
+  return data.to_json();
+}
+
+// Report the first line where s1 and s2 differ
+void report(const string & what, const string & s1, const string & s2)
+{
+  istringstream in1(s1), in2(s2);
+  string l1, l2;
+  for (size_t n = 1; ; ++n)
+    {
+      const bool ok1 = bool(getline(in1, l1)), ok2 = bool(getline(in2, l2));
+      if (not ok1 and not ok2)
+	return;
+      if (l1 != l2 or ok1 != ok2)
+	{
+	  cout << what << ", line " << n << ":" << endl
+	       << "  stream:   " << (ok1 ? l1 : "<end>") << endl
+	       << "  document: " << (ok2 ? l2 : "<end>") << endl;
+	  return;
+	}
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  size_t errors = 0, checked = 0;
+  for (const auto & name : files.getValue())
+    {
+      ifstream input(name);
+      if (not input)
+	{
+	  cout << "cannot open " << name << endl;
+	  ++errors;
+	  continue;
+	}
+      ostringstream s;
+      s << input.rdbuf();
+      const string text = s.str();
+
+      json j;
+      try
+	{
+	  j = json::parse(text);
+	}
+      catch (exception & e)
+	{
+	  cout << name << ": " << e.what() << endl;
+	  ++errors;
+	  continue;
+	}
+      if (not j.is_object() or j.find("varsets") == j.end())
+	{
+	  cout << name << " skipped: it has no var sets" << endl;
+	  continue;
+	}
+
+      ++checked;
+      try
+	{
+	  const string expected = from_document(j);
+	  const string loaded = from_stream(text);
+	  if (loaded != expected)
+	    {
+	      report(name, loaded, expected);
+	      ++errors;
+	    }
+
+	  json extra = j;
+	  extra["unknown"] = { { "a", { 1, 2, { { "b", nullptr } } } } };
+	  for (auto & vset : extra["varsets"])
+	    {
+	      vset["unknown"] = "var set";
+	      for (auto & var : vset["variables"])
+		var["unknown"] = 1.5;
+	    }
+	  const string skipped = from_stream(extra.dump(1));
+	  if (skipped != expected)
+	    {
+	      report(name + " with unknown keys", skipped, expected);
+	      ++errors;
+	    }
+	}
+      catch (exception & e)
+	{
+	  cout << name << ": " << e.what() << endl;
+	  ++errors;
+	}
+    }
+
+  cout << checked << " files compared" << endl;
+  if (errors)
+    {
+      cout << errors << " errors" << endl;
+      return 1;
+    }
+
+  cout << "Json reader test passed" << endl;
+  return 0;
+}
@@ -0,0 +1,118 @@
+/** Checks of the Monte Carlo engine
+
+    - Philox4x32-10 gives the known answer of its reference
+      implementation,
+    - the percentiles of a run do not depend on the number of threads
+      nor on the batch size and
+    - the streamed P10, P50 and P90 of normal, uniform and triangular
+      inputs are close to the exact ones.
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <iostream>
+
+# include <tclap/CmdLine.h>
+
+# include <pvt-monte-carlo.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-monte-carlo", ' ', "0" };
+
+ValueArg<size_t> n = { "n", "n", "realisations", false, 200000,
+		       "realisations", cmd };
+
+ValueArg<unsigned long> seed = { "s", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+ValueArg<size_t> threads = { "t", "threads", "maximum number of threads",
+			     false, 8, "number of threads", cmd };
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  size_t errors = 0;
+
+  Philox g(0, 0);
+  const uint32_t kat[4] = { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 };
+  for (size_t i = 0; i < 4; ++i)
+    if (g.next32() != kat[i])
+      {
+	cout << "Philox word " << i << " differs from the known answer" << endl;
+	++errors;
+      }
+
+  MonteCarlo mc(seed.getValue());
+  mc.add_input("normal", McDistribution::parse("normal 30 2"));
+  mc.add_input("uniform", McDistribution::parse("uniform 10 20"));
+  mc.add_input("triangular", McDistribution::parse("triangular 0 1 4"));
+
+  // exact P10, P50 and P90 of every input
+  const double exact[3][3] =
+    { { 30 - 2*1.2815516, 30, 30 + 2*1.2815516 },
+      { 11, 15, 19 },
+      { sqrt(0.4), 4 - sqrt(6), 4 - sqrt(1.2) } };
+  const double tol[3] = { 0.05, 0.05, 0.02 };
+
+  auto run = [&] (size_t num_threads, size_t batch)
+    {
+      mc.set_num_threads(num_threads);
+      mc.set_batch_size(batch);
+      PercentileGrid grid(3, { 0.1, 0.5, 0.9 });
+      mc.run(n.getValue(), grid, [] (size_t, const double * x, double * out)
+	{
+	  copy(x, x + 3, out);
+	});
+      return grid;
+    };
+
+  const PercentileGrid ref = run(1, 1);
+  for (size_t c = 0; c < 3; ++c)
+    for (size_t j = 0; j < 3; ++j)
+      if (fabs(ref.value(c, j) - exact[c][j]) > tol[c])
+	{
+	  cout << mc.inputs()(c).name << " P" << int(100*ref.probability(j))
+	       << " = " << ref.value(c, j) << " (expected " << exact[c][j]
+	       << ")" << endl;
+	  ++errors;
+	}
+
+  for (size_t nt = 2; nt <= threads.getValue(); nt *= 2)
+    {
+      const PercentileGrid grid = run(nt, 0);
+      for (size_t c = 0; c < 3; ++c)
+	for (size_t j = 0; j < 3; ++j)
+	  if (grid.value(c, j) != ref.value(c, j))
+	    {
+	      cout << "With " << nt << " threads " << mc.inputs()(c).name
+		   << " P" << int(100*grid.probability(j)) << " = "
+		   << grid.value(c, j) << " != " << ref.value(c, j) << endl;
+	      ++errors;
+	    }
+    }
+
+  // an empty grid must not evaluate the model
+  mc.set_num_threads(threads.getValue());
+  PercentileGrid empty(0, { 0.5 });
+  size_t calls = 0;
+  mc.run(n.getValue(), empty, [&calls] (size_t, const double*, double*)
+    {
+      ++calls;
+    });
+  if (calls)
+    {
+      cout << "The model was evaluated for an empty grid" << endl;
+      ++errors;
+    }
+
+  if (errors)
+    {
+      cout << errors << " errors" << endl;
+      return 1;
+    }
+
+  cout << "Monte Carlo test passed" << endl;
+  return 0;
+}
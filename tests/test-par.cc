@@ -1,4 +1,5 @@
 
+# include <cassert>
 # include <iostream>
 # include <correlations/par-list.H>
 
@@ -27,7 +28,36 @@ void test()
        << uo << endl;
 }
 
+void test_dense()
+{
+  DenseParList plist;
+
+  plist.insert("p", 100, &psia::get_instance());
+  plist.insert("rs", 1110, &SCF_STB::get_instance());
+  plist.insert(par_id("t"), 180, &Fahrenheit::get_instance());
+
+  assert(plist.contains(par_id("p")) and plist.contains(par_id("t")));
+  assert(plist.search("rs").raw() == 1110);
+
+  // search by ids with conversion to the unit of the matching id
+  DynList<IdPair> ids = { IdPair(par_id("temp"), &Rankine::get_instance()),
+			  IdPair(par_id("t"), &Rankine::get_instance()) };
+  cout << plist.search(ids) << endl;
+
+  plist.remove("rs");
+  assert(not plist.contains(par_id("rs")));
+  try
+    {
+      plist.search("rs");
+      assert(false);
+    }
+  catch (ParameterNameNotFound &) {}
+
+  cout << plist << endl;
+}
+
 int main()
 {
   test();
+  test_dense();
 }
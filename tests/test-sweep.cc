@@ -0,0 +1,254 @@
+/** Checks that a CorrelationSweep gives the same rows as a sequential
+    evaluation of its points
+
+    For every correlation (or only the one given with -c) the points of
+    a sweep of n values per axis are generated by an odometer
+    independent of CorrelationSweep::point() and evaluated at once with
+    Correlation::compute_batch(). Then the sweep is run with several
+    numbers of threads and block sizes; the blocks must be emitted in
+    increasing order, contiguous, with the results and the csv rows of
+    the sequential evaluation. Finally, a sweep stopped by emit() must
+    return the end of the last emitted block, and an exception thrown
+    by format() or emit() must reach the caller of run().
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <cmath>
+# include <iostream>
+# include <stdexcept>
+
+# include <tclap/CmdLine.h>
+
+# include <correlations/pvt-correlations.H>
+# include <correlations/correlation-sweep.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-sweep", ' ', "0" };
+
+ValueArg<string> corr_name = { "c", "correlation", "correlation name", false,
+			       "", "correlation name", cmd };
+
+ValueArg<size_t> n = { "n", "n", "number of values per axis", false, 4,
+		       "number of values per axis", cmd };
+
+struct Reference
+{
+  size_t total = 0;
+  CorrelationSweep::Block all; // every point in a single block
+};
+
+// Evaluate sequentially the points of sweep, generated by incrementing
+// the digits of the axes from the last one
+Reference reference(const CorrelationSweep & sweep)
+{
+  const size_t np = sweep.num_pars();
+  Reference ref;
+  ref.total = sweep.size();
+  CorrelationSweep::Block & b = ref.all;
+  b.n = ref.total;
+  b.args.resize(b.n*np);
+  b.results.resize(b.n);
+
+  vector<size_t> digits(np, 0);
+  for (size_t k = 0; k < b.n; ++k)
+    {
+      for (size_t i = 0; i < np; ++i)
+	b.args[k*np + i] = sweep.axis(i).value(digits[i]);
+      for (long i = long(np) - 1; i >= 0; --i)
+	if (++digits[i] < sweep.axis(i).n)
+	  break;
+	else
+	  digits[i] = 0;
+    }
+
+  b.failures = sweep.correlation()->compute_batch(b.args.data(), b.n,
+						  b.results.data(), false);
+  CorrelationSweep::format_csv(b, np);
+  return ref;
+}
+
+size_t check_point(const CorrelationSweep & sweep, const Reference & ref)
+{
+  const size_t np = sweep.num_pars();
+  vector<double> args(max<size_t>(np, 1));
+  for (size_t k = 0; k < ref.total; ++k)
+    {
+      sweep.point(k, args.data());
+      for (size_t i = 0; i < np; ++i)
+	if (args[i] != ref.all.args[k*np + i])
+	  {
+	    cout << sweep.correlation()->name << ": point(" << k
+		 << ") differs in the parameter " << i << endl;
+	    return 1;
+	  }
+    }
+  return 0;
+}
+
+// Run sweep on nt threads with blocks of bs points and compare the
+// emitted blocks against ref
+size_t check_run(CorrelationSweep & sweep, const Reference & ref,
+		 size_t nt, size_t bs)
+{
+  const size_t np = sweep.num_pars();
+  sweep.set_num_threads(nt);
+  sweep.set_block_size(bs);
+
+  size_t next = 0, errors = 0;
+  string out;
+  const size_t ret = sweep.run([np] (auto & b)
+    {
+      CorrelationSweep::format_csv(b, np);
+    },
+    [&] (const auto & b)
+    {
+      if (b.first != next or b.n != min(bs, ref.total - b.first))
+	{
+	  cout << "block [" << b.first << ", " << b.first + b.n
+	       << ") emitted after " << next << endl;
+	  ++errors;
+	}
+      size_t failures = 0;
+      for (size_t k = 0; k < b.n; ++k)
+	{
+	  const double r = b.results[k];
+	  failures += r == Unit::Invalid_Value;
+	  if (r != ref.all.results[b.first + k] and
+	      not (std::isnan(r) and std::isnan(ref.all.results[b.first + k])))
+	    {
+	      cout << "point " << b.first + k << " = " << r << " (sequential "
+		   << ref.all.results[b.first + k] << ")" << endl;
+	      ++errors;
+	    }
+	}
+      if (failures != b.failures)
+	{
+	  cout << "block " << b.first << " has " << b.failures
+	       << " failures instead of " << failures << endl;
+	  ++errors;
+	}
+      next = b.first + b.n;
+      out += b.out;
+      return true;
+    });
+
+  if (ret != ref.total or next != ref.total)
+    {
+      cout << "run() returned " << ret << " after emitting " << next
+	   << " of " << ref.total << " points" << endl;
+      ++errors;
+    }
+  if (out != ref.all.out)
+    {
+      cout << "the csv rows differ from the sequential ones" << endl;
+      ++errors;
+    }
+  if (errors)
+    cout << sweep.correlation()->name << ": " << errors << " errors with "
+	 << nt << " threads and blocks of " << bs << endl;
+  return errors;
+}
+
+// Stop after the third block; throw from emit() and from format()
+size_t check_stop(CorrelationSweep & sweep, const Reference & ref)
+{
+  const size_t bs = 3;
+  if (ref.total <= 5*bs) // the block 4 is needed
+    return 0;
+  sweep.set_num_threads(2);
+  sweep.set_block_size(bs);
+  size_t errors = 0;
+
+  size_t emitted = 0;
+  const size_t ret = sweep.run([] (auto &) {}, [&emitted] (const auto &)
+    {
+      return ++emitted < 3;
+    });
+  if (ret != 3*bs or emitted != 3)
+    {
+      cout << "stopped sweep returned " << ret << " after " << emitted
+	   << " blocks" << endl;
+      ++errors;
+    }
+
+  for (size_t phase = 0; phase < 2; ++phase)
+    try
+      {
+	emitted = 0;
+	sweep.run([phase] (auto & b)
+	  {
+	    if (phase == 1 and b.first == 4*bs)
+	      throw domain_error("format");
+	  },
+	  [phase, &emitted] (const auto &)
+	  {
+	    if (phase == 0 and emitted == 2)
+	      throw domain_error("emit");
+	    ++emitted;
+	    return true;
+	  });
+	cout << "the exception of " << (phase ? "format" : "emit")
+	     << " was lost" << endl;
+	++errors;
+      }
+    catch (domain_error & e)
+      {
+	if (e.what() != string(phase ? "format" : "emit") or
+	    emitted != (phase ? 4 : 2))
+	  {
+	    cout << "exception " << e.what() << " after " << emitted
+		 << " blocks" << endl;
+	    ++errors;
+	  }
+      }
+
+  if (errors)
+    cout << sweep.correlation()->name << ": " << errors
+	 << " errors stopping the sweep" << endl;
+  return errors;
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  DynList<const Correlation*> corrs;
+  if (corr_name.isSet())
+    {
+      const Correlation * corr_ptr =
+	Correlation::search_by_name(corr_name.getValue());
+      if (corr_ptr == nullptr)
+	{
+	  cout << "Correlation " << corr_name.getValue() << " not found"
+	       << endl;
+	  return 1;
+	}
+      corrs.append(corr_ptr);
+    }
+  else
+    corrs = Correlation::list();
+
+  size_t errors = 0, num_corrs = 0;
+  for (auto it = corrs.get_it(); it.has_curr(); it.next(), ++num_corrs)
+    {
+      CorrelationSweep sweep(it.get_curr(), n.getValue());
+      const Reference ref = reference(sweep);
+      errors += check_point(sweep, ref);
+      for (size_t nt : { 1, 2, 3, 8 })
+	for (size_t bs : { 1, 7, 64, 1 << 14 })
+	  errors += check_run(sweep, ref, nt, bs);
+      errors += check_stop(sweep, ref);
+    }
+
+  cout << num_corrs << " correlations swept" << endl;
+  if (errors)
+    {
+      cout << errors << " errors" << endl;
+      return 1;
+    }
+
+  cout << "Correlation sweep test passed" << endl;
+  return 0;
+}
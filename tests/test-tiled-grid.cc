@@ -0,0 +1,183 @@
+/** Checks that the lookups of a TiledGrid are the ones of a PvtGrid of
+    the same nodes
+
+    A FluidModelStandard computes the nodes of a csv grid with the axes
+    of a TiledGrid of the same model; both grids are then looked up at
+    random points of the axes and at points around the bubble point of
+    the isotherms and of the temperatures between them, where the
+    values are interpolated across pb. A lookup must fail in both grids
+    or give the same value within the tolerance. The value of the
+    TiledGrid at a node that is not an upper border of the axes must be
+    exactly the one of the model.
+
+    Aleph-w Leandro Rabindranath Leon
+ */
+# include <cmath>
+# include <random>
+# include <sstream>
+# include <iomanip>
+# include <iostream>
+
+# include <tclap/CmdLine.h>
+
+# include <correlations/pvt-correlations.H>
+# include <correlations/fluid-models.H>
+# include <pvt-grid-compute.H>
+# include <pvt-tiled-grid.H>
+
+using namespace std;
+using namespace TCLAP;
+
+CmdLine cmd = { "test-tiled-grid", ' ', "0" };
+
+ValueArg<size_t> n = { "n", "n", "number of random points", false, 10000,
+		       "number of random points", cmd };
+
+ValueArg<unsigned long> seed = { "s", "seed", "random seed", false, 0,
+				 "random seed", cmd };
+
+ValueArg<double> tol = { "t", "tolerance", "maximum relative error", false,
+			 1e-10, "tolerance", cmd };
+
+using Grid = TiledGrid<FluidModelStandard>;
+
+// Csv with the nodes of taxis x paxis computed by model; an invalid
+// value is an empty field
+string grid_csv(const FluidModelStandard & model, const Grid & grid)
+{
+  ostringstream out;
+  out << setprecision(17) << "t " << model.t_unit().name << ",p "
+      << model.p_unit().name;
+  for (auto it = grid.properties().get_it(); it.has_curr(); it.next())
+    out << "," << it.get_curr().first << " " << it.get_curr().second->name;
+  out << endl;
+
+  const Grid::Axis & taxis = grid.t_axis(), & paxis = grid.p_axis();
+  for (size_t i = 0; i < taxis.n; ++i)
+    {
+      const auto tstate = model.temperature(taxis.value(i));
+      for (size_t j = 0; j < paxis.n; ++j)
+	{
+	  const auto row = model.compute(tstate, paxis.value(j));
+	  out << taxis.value(i) << "," << paxis.value(j);
+	  for (auto v : { row.bo, row.co, row.rs, row.uo }) // by name
+	    {
+	      out << ",";
+	      if (v != Unit::Invalid_Value)
+		out << v;
+	    }
+	  out << endl;
+	}
+    }
+  return out.str();
+}
+
+int main(int argc, char *argv[])
+{
+  cmd.parse(argc, argv);
+
+  FluidModelStandard model(Fahrenheit::get_instance(), psia::get_instance());
+  model.set_constant("api", VtlQuantity(Api::get_instance(), 25));
+  model.set_constant("yg", VtlQuantity(Sgg::get_instance(), 0.8));
+  model.set_constant("rsb", VtlQuantity(SCF_STB::get_instance(), 600));
+  model.set_constant("tsep", VtlQuantity(Fahrenheit::get_instance(), 80));
+  model.set_constant("psep", VtlQuantity(psia::get_instance(), 100));
+  model.prepare();
+
+  // steps of 2 and 10, so that the nodes are exact
+  const Grid tiled(model, Grid::Axis(80, 280, 101),
+		   Grid::Axis(15, 5015, 501));
+  istringstream in(grid_csv(model, tiled));
+  const PvtGrid grid(in);
+
+  const Grid::Axis & taxis = tiled.t_axis(), & paxis = tiled.p_axis();
+  const auto & props = tiled.properties();
+  size_t errors = 0, points = 0, failed = 0;
+
+  auto check = [&] (double t, double p)
+    {
+      const VtlQuantity temp(model.t_unit(), t), pressure(model.p_unit(), p);
+      ++points;
+      for (size_t k = 0; k < props.size(); ++k)
+	{
+	  const string & name = props(k).first;
+	  double v = NAN, ref = NAN;
+	  try { v = tiled.compute(k, temp, pressure).raw(); }
+	  catch (OutOfRange &) {}
+	  try { ref = grid.compute(name, temp, pressure).raw(); }
+	  catch (OutOfRange &) {}
+	  if (std::isnan(v) and std::isnan(ref))
+	    {
+	      ++failed;
+	      continue;
+	    }
+	  const double e = std::isnan(v) or std::isnan(ref) ? INFINITY :
+	    ref != 0 ? fabs(v - ref)/fabs(ref) : fabs(v);
+	  if (e <= tol.getValue())
+	    continue;
+	  cout << setprecision(17) << name << "(t = " << t << ", p = " << p
+	       << ") = " << v << " (PvtGrid " << ref << ")" << endl;
+	  ++errors;
+	}
+    };
+
+  // nodes: exactly the values of the model, but for the last ones,
+  // which are the upper borders of the last cells
+  for (size_t i = 0; i + 1 < taxis.n; ++i)
+    {
+      const double t = taxis.value(i);
+      const auto tstate = model.temperature(t);
+      for (size_t j = 0; j + 1 < paxis.n; ++j)
+	{
+	  const double p = paxis.value(j);
+	  const auto row = model.compute(tstate, p);
+	  const double vals[] = { row.bo, row.co, row.rs, row.uo };
+	  for (size_t k = 0; k < props.size(); ++k)
+	    {
+	      const VtlQuantity temp(model.t_unit(), t),
+		pressure(model.p_unit(), p);
+	      double v = Unit::Invalid_Value;
+	      try { v = tiled.compute(k, temp, pressure).raw(); }
+	      catch (OutOfRange &) {}
+	      if (v == vals[k])
+		continue;
+	      cout << setprecision(17) << props(k).first << "(t = " << t
+		   << ", p = " << p << ") = " << v << " (model " << vals[k]
+		   << ")" << endl;
+	      ++errors;
+	    }
+	}
+    }
+
+  mt19937_64 rng(seed.getValue());
+  uniform_real_distribution<double> unif(0, 1);
+  const double tmax = taxis.value(taxis.n - 1);
+  const double pmax = paxis.value(paxis.n - 1);
+  for (size_t i = 0; i < n.getValue(); ++i)
+    check(taxis.min + unif(rng)*(tmax - taxis.min),
+	  paxis.min + unif(rng)*(pmax - paxis.min));
+
+  // around pb on the isotherms and halfway between them
+  for (size_t i = 0; i < 2*taxis.n - 1; ++i)
+    {
+      const double t = taxis.min + 0.5*i*taxis.step;
+      const double pb = model.temperature(t).pb_p;
+      if (pb == Unit::Invalid_Value or pb <= paxis.min or pb >= pmax)
+	continue;
+      for (double p : { pb, nextafter(pb, 0.0), nextafter(pb, pmax),
+	    pb*(1 - 1e-6), pb*(1 + 1e-6), pb - 0.5*paxis.step,
+	    pb + 0.5*paxis.step })
+	check(t, p);
+    }
+
+  cout << points << " points, " << failed
+       << " lookups out of range in both grids" << endl;
+  if (errors)
+    {
+      cout << errors << " lookups differ" << endl;
+      return 1;
+    }
+
+  cout << "Tiled grid test passed" << endl;
+  return 0;
+}
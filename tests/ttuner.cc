@@ -25,6 +25,7 @@
 auto & __units_system = UnitsInstancer::init();
 
 # include <metadata/pvt-tuner.H>
+# include <metadata/batch-calibration.H>
 
 using namespace std;
 using namespace TCLAP;
@@ -684,7 +685,7 @@ SwitchArg transpose_out = { "", "transpose", "transpose output", cmd };
   double c_##NAME = 0;							\
   double m_##NAME = 1;							\
 									\
-  void set_##NAME##_corr()						\
+  void set_##NAME##_corr(PvtData & data = ::data)			\
   {									\
     if (not NAME##_corr_arg.isSet() and not NAME##_cal_corr_arg.isSet()) \
       return;								\
@@ -887,31 +888,31 @@ void set_relax_names()
     relax_names_tbl.append(p);
 }
 
-void remove_consts()
+void remove_consts(PvtData & data = ::data)
 {
   for (auto & c : rm_const.getValue())
     data.rm_const(c);
 }
 
-void remove_properties()
+void remove_properties(PvtData & data = ::data)
 {
   for (auto & p : rm_property.getValue())
     data.rm_vector(p.t, p.yname);
 }
 
-void set_correlations()
+void set_correlations(PvtData & data = ::data)
 {
-  set_pb_corr();
-  set_rs_corr();
-  set_bob_corr();
-  set_boa_corr();
-  set_coa_corr();
-  set_uod_corr();
-  set_uob_corr();
-  set_uoa_corr();
+  set_pb_corr(data);
+  set_rs_corr(data);
+  set_bob_corr(data);
+  set_boa_corr(data);
+  set_coa_corr(data);
+  set_uod_corr(data);
+  set_uob_corr(data);
+  set_uoa_corr(data);
 }
 
-void split_uo()
+void split_uo(PvtData & data = ::data)
 {
   DynList<const VectorDesc*> uo_vectors = data.search_vectors("uo");
   if (uo_vectors.is_empty())
@@ -1523,7 +1524,7 @@ static DynMapTree<string, PvtData::AutoApplyType> auto_map =
     { "m", PvtData::AutoApplyType::m }
   };
 
-void report_top_stats(const DynList<PvtData::StatsDesc> & corr_list)
+string top_stats_report(const DynList<PvtData::StatsDesc> & corr_list)
 {
   DynList<DynList<string>> rows = corr_list.maps<DynList<string>>([] (auto & s)
     {
@@ -1536,9 +1537,14 @@ void report_top_stats(const DynList<PvtData::StatsDesc> & corr_list)
 
   const auto & out_type = output.getValue();
   if (out_type == "csv")
-    cout << Aleph::to_string(format_string_csv(rows)) << endl;
+    return Aleph::to_string(format_string_csv(rows));
   else
-    cout << Aleph::to_string(format_string(rows)) << endl;
+    return Aleph::to_string(format_string(rows));
+}
+
+void report_top_stats(const DynList<PvtData::StatsDesc> & corr_list)
+{
+  cout << top_stats_report(corr_list) << endl;
 
   corr_list.for_each([] (auto & s) { data.set_correlation(s); });
 }
@@ -1610,11 +1616,47 @@ void process_auto_input()
   data.auto_inputing();
 }
 
+BatchArgs batch_args = { cmd };
+
+// Calibrate the fluids of --batch (see batch-calibration.H). They are
+// calibrated on several threads, which only read globals set before
+// the batch starts (the options and relax_names_tbl), and
+// PvtData::min_uo_val() and min_uod_val(), which are thread safe
+void process_batch()
+{
+  if (not batch_args.is_set())
+    return;
+
+  const PvtData::AutoApplyType type = auto_map[auto_type.getValue()];
+  auto prepare = [] (PvtData & data)
+    {
+      remove_consts(data);
+      remove_properties(data);
+      if (split_uo_arg.getValue())
+	split_uo(data);
+      set_correlations(data);
+    };
+  auto auto_apply = [type] (PvtData & data)
+    {
+      return data.auto_apply(relax_names_tbl, ban.getValue().corr_list,
+			     threshold.getValue(), type, auto_n.getValue());
+    };
+  batch_args.run([&] (const string & name, BatchResult & r)
+    {
+      calibrate_fluid<PvtData>(name, r, prepare, auto_apply, top_stats_report);
+    }, output.getValue() == "csv" ? ".csv" : ".txt");
+
+  terminate_app();
+}
+
 int main(int argc, char *argv[])
 {
   cmd.parse(argc, argv);
   try
     {
+      set_relax_names();
+      process_batch();
+
       test_load_file();
       build_pvt_data();
       remove_consts();
@@ -1624,7 +1666,6 @@ int main(int argc, char *argv[])
 	split_uo();
 
       set_correlations();
-      set_relax_names();
       input_data();
 
       if (not data.defined())
@@ -9,6 +9,8 @@
 # include <json.hpp>
 
 # include <metadata/pvt-calibrate.H>
+# include <metadata/batch-calibration.H>
+# include <correlations/correlation-cache-args.H>
 
 using namespace std;
 using namespace TCLAP;
@@ -620,7 +622,7 @@ SwitchArg pbexp_arg = { "", "pbexp", "put experimental pb values", cmd };
   double c_##NAME = 0;							\
   double m_##NAME = 1;							\
 									\
-  void set_##NAME##_corr()						\
+  void set_##NAME##_corr(PvtData & data = ::data)			\
   {									\
     if (not NAME##_corr_arg.isSet() and not NAME##_cal_corr_arg.isSet()) \
       return;								\
@@ -749,13 +751,13 @@ void set_relax_names()
     relax_names_tbl.append(p);
 }
 
-void remove_consts()
+void remove_consts(PvtData & data = ::data)
 {
   for (auto & c : rm_const.getValue())
     data.rm_const(c);
 }
 
-void remove_properties()
+void remove_properties(PvtData & data = ::data)
 {
   for (auto & p : rm_property.getValue())
     data.rm_vector(p.t, p.yname);
@@ -865,6 +867,8 @@ void terminate_app()
 
 SwitchArg print_uod = { "", "print_uod", "only print uod value", cmd };
 
+CorrelationCacheArgs cache_args = { cmd };
+
 void process_print_data()
 {
   if (not print.getValue())
@@ -1009,13 +1013,8 @@ DynList<PvtData::AutoDesc> best_list()
 			 threshold, auto_map[auto_type.getValue()]);
 }
 
-void process_auto()
+string auto_report(const DynList<PvtData::AutoDesc> & corr_list)
 {
-  if (not auto_arg.isSet())
-    return;
-
-  auto corr_list = best_list();
-
   DynList<DynList<string>> rows = corr_list.maps<DynList<string>>([] (auto & a)
     {
       DynList<string> ret = build_dynlist<string>(a.corr_ptr->name);
@@ -1029,9 +1028,17 @@ void process_auto()
 
   const auto & out_type = output.getValue();
   if (out_type == "csv")
-    cout << Aleph::to_string(format_string_csv(rows)) << endl;
+    return Aleph::to_string(format_string_csv(rows));
   else
-    cout << Aleph::to_string(format_string(rows)) << endl;
+    return Aleph::to_string(format_string(rows));
+}
+
+void process_auto()
+{
+  if (not auto_arg.isSet())
+    return;
+
+  cout << auto_report(best_list()) << endl;
 
   terminate_app();
 }
@@ -1711,7 +1718,7 @@ void process_R()
   system(plotr.c_str());
 }
 
-void split_uo()
+void split_uo(PvtData & data = ::data)
 {
   DynList<const VectorDesc*> uo_vectors = data.search_vectors("uo");
   if (uo_vectors.is_empty())
@@ -1746,22 +1753,59 @@ void test_load_file()
     }
 }
 
-void set_correlations()
+void set_correlations(PvtData & data = ::data)
 {
-  set_pb_corr();
-  set_rs_corr();
-  set_bob_corr();
-  set_boa_corr();
-  set_coa_corr();
-  set_uod_corr();
-  set_uob_corr();
-  set_uoa_corr();
+  set_pb_corr(data);
+  set_rs_corr(data);
+  set_bob_corr(data);
+  set_boa_corr(data);
+  set_coa_corr(data);
+  set_uod_corr(data);
+  set_uob_corr(data);
+  set_uoa_corr(data);
 }    
 
+BatchArgs batch_args = { cmd };
+
+// Calibrate the fluids of --batch (see batch-calibration.H). They are
+// calibrated on several threads, which only read globals set before
+// the batch starts (the options and relax_names_tbl) and the local
+// statics of pvt-calibrate.H, whose initialization is thread safe
+void process_batch()
+{
+  if (not batch_args.is_set())
+    return;
+
+  const PvtData::AutoApplyType type = auto_map[auto_type.getValue()];
+  auto prepare = [] (PvtData & data)
+    {
+      remove_consts(data);
+      remove_properties(data);
+      if (split_uo_arg.getValue())
+	split_uo(data);
+      set_correlations(data);
+    };
+  auto auto_apply = [type] (PvtData & data)
+    {
+      return data.auto_apply(relax_names_tbl, ban.getValue().corr_list,
+			     threshold.getValue(), type);
+    };
+  batch_args.run([&] (const string & name, BatchResult & r)
+    {
+      calibrate_fluid<PvtData>(name, r, prepare, auto_apply, auto_report);
+    }, output.getValue() == "csv" ? ".csv" : ".txt");
+
+  terminate_app();
+}
+
 int main(int argc, char *argv[])
 {
   UnitsInstancer::init();
   cmd.parse(argc, argv);
+  cache_args.enable();
+
+  set_relax_names();
+  process_batch();
 
   test_load_file();
 
@@ -1773,7 +1817,6 @@ int main(int argc, char *argv[])
     split_uo();
 
   set_correlations();
-  set_relax_names();
   input_data();
 
   if (not data.defined())